@@ -0,0 +1,85 @@
+//CS601 Endsem: benchmark for MyContainer growth against std::vector, and for
+//batched suffix concatenation (StringArena) against repeated operator+ style appends.
+//Usage: ./bench <number of elements>
+#include<iostream>
+#include<cstdlib>
+#include<chrono>
+#include<vector>
+#include<string>
+#include"mycontainer.h"
+using namespace std;
+
+template <typename Container, typename Make>
+double timeAppend(int n, Make make, long& checksum) {
+	const auto start=std::chrono::steady_clock::now();
+	Container c;
+	for(int i=0;i<n;i++)
+		c.push_back(make(i));
+	const auto end=std::chrono::steady_clock::now();
+	checksum += c.size();
+	const std::chrono::duration<double> elapsedtime = end-start;
+	return elapsedtime.count();
+}
+
+//Appends "_"+suffix to every string with the per-element `s += "_"+suffix` of operator+
+double timeConcatLoop(MyContainer<string>& labels, const string& suffix) {
+	const auto start=std::chrono::steady_clock::now();
+	for(int i=0;i<labels.size();i++)
+		labels[i] += "_"+suffix;
+	const auto end=std::chrono::steady_clock::now();
+	const std::chrono::duration<double> elapsedtime = end-start;
+	return elapsedtime.count();
+}
+
+//Same result built in place by StringArena::appendSuffix
+double timeConcatInPlace(MyContainer<string>& labels, const string& suffix, bool parallel) {
+	const auto start=std::chrono::steady_clock::now();
+	StringArena::appendSuffix(labels, suffix, nullptr, parallel);
+	const auto end=std::chrono::steady_clock::now();
+	const std::chrono::duration<double> elapsedtime = end-start;
+	return elapsedtime.count();
+}
+
+//Same result built in one StringArena
+double timeConcatArena(const MyContainer<string>& labels, const string& suffix, bool parallel, size_t& bytes) {
+	const auto start=std::chrono::steady_clock::now();
+	StringArena arena(labels, suffix, nullptr, parallel);
+	const auto end=std::chrono::steady_clock::now();
+	bytes = arena.bytes();
+	const std::chrono::duration<double> elapsedtime = end-start;
+	return elapsedtime.count();
+}
+
+int main(int argc, char* argv[]){
+	int n = (argc > 1) ? atoi(argv[1]) : 10000000;
+	long checksum = 0;
+
+	auto makeDouble = [](int i) { return 0.5*i; };
+	auto makeString = [](int i) { return to_string(i); };
+
+	double tMyDouble  = timeAppend<MyContainer<double> >(n, makeDouble, checksum);
+	double tVecDouble = timeAppend<vector<double> >(n, makeDouble, checksum);
+	double tMyString  = timeAppend<MyContainer<string> >(n/10, makeString, checksum);
+	double tVecString = timeAppend<vector<string> >(n/10, makeString, checksum);
+
+	cout<<"push_back "<<n<<" doubles:      MyContainer "<<tMyDouble<<" s, std::vector "<<tVecDouble<<" s"<<endl;
+	cout<<"push_back "<<n/10<<" strings:       MyContainer "<<tMyString<<" s, std::vector "<<tVecString<<" s"<<endl;
+	MyContainer<string> labels;
+	labels.reserve(n/10);
+	for(int i=0;i<n/10;i++)
+		labels.push_back("node"+to_string(i));
+	MyContainer<string> labelsCopy(labels), labelsInPlace(labels), labelsInPlacePar(labels);
+	size_t bytes = 0;
+	double tArena = timeConcatArena(labels, "iit", false, bytes);
+	double tArenaPar = timeConcatArena(labels, "iit", true, bytes);
+	double tLoop = timeConcatLoop(labelsCopy, "iit");
+	double tInPlace = timeConcatInPlace(labelsInPlace, "iit", false);
+	double tInPlacePar = timeConcatInPlace(labelsInPlacePar, "iit", true);
+	cout<<"suffix "<<n/10<<" strings:         operator+ loop "<<tLoop<<" s, appendSuffix "<<tInPlace<<" s, appendSuffix parallel "<<tInPlacePar<<" s"<<endl;
+	cout<<"                                 StringArena "<<tArena<<" s, StringArena parallel "<<tArenaPar<<" s ("<<bytes<<" bytes)"<<endl;
+	for(int i=0;i<labels.size();i+=labels.size()/100+1)
+		if(labelsInPlace[i]!=labelsCopy[i] || labelsInPlacePar[i]!=labelsCopy[i])
+			cout<<"mismatch at "<<i<<endl;
+	cout<<"checksum "<<checksum<<endl;
+	return 0;
+}
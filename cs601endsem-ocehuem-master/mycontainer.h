@@ -3,42 +3,213 @@
 
 #include <stdexcept>
 #include <string>
-int numLinesOfCodeAdded = 70; 
-std::string me = "Harshitha(220010015)";  
+#include <new>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <climits>
+#include <cstdint>
+#include <type_traits>
+#include <string_view>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+int numLinesOfCodeAdded = 70;
+std::string me = "Harshitha(220010015)";
 
 template <typename T>
 class MyContainer {
 private:
     int len;    // Length of the container
+    int cap;    // Number of elements the storage can hold without growing
     T* data;    // Dynamically allocated array for storing elements
+    bool mapped; // Storage comes from mmap (large trivially copyable buffers)
+
+    // Trivially copyable buffers of at least this many bytes are moved to mmap
+    // so that growing them is an mremap (page table update) instead of a copy.
+    static const size_t mmapThreshold = 1 << 20;
+
+    // Largest capacity: len and cap are int, and the byte count must fit size_t
+    static long maxCapacity() {
+        const size_t maxElements = SIZE_MAX / sizeof(T);
+        return maxElements < (size_t)INT_MAX ? (long)maxElements : (long)INT_MAX;
+    }
+
+    static size_t pageRound(size_t bytes) {
+        const size_t page = 4096;
+        return (bytes + page - 1) & ~(page - 1);
+    }
+
+    // Allocate raw, unconstructed storage for n elements
+    static T* allocate(int n) {
+        if (n == 0) return nullptr;
+        void* p = std::malloc(sizeof(T) * n);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    // Release storage obtained from allocate() or the mmap path
+    void deallocate() {
+#ifdef __linux__
+        if (mapped) {
+            munmap(data, pageRound(sizeof(T) * cap));
+            mapped = false;
+            return;
+        }
+#endif
+        std::free(data);
+    }
+
+    // Grow trivially copyable storage in place where possible: realloc for
+    // small buffers, mremap once the buffer crosses mmapThreshold.
+    void reallocateTrivial(int newCap) {
+        size_t newBytes = sizeof(T) * newCap;
+#ifdef __linux__
+        if (newBytes >= mmapThreshold) {
+            size_t newMapBytes = pageRound(newBytes);
+            void* p;
+            if (mapped) {
+                p = mremap(data, pageRound(sizeof(T) * cap), newMapBytes, MREMAP_MAYMOVE);
+            } else {
+                p = mmap(nullptr, newMapBytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p != MAP_FAILED) {
+                    if (len > 0) std::memcpy(p, data, sizeof(T) * len);
+                    std::free(data);
+                }
+            }
+            if (p == MAP_FAILED) throw std::bad_alloc();
+            data = static_cast<T*>(p);
+            mapped = true;
+            // The page-rounded tail may hold more elements than an int counts
+            size_t mappedCap = newMapBytes / sizeof(T);
+            cap = mappedCap > (size_t)INT_MAX ? INT_MAX : static_cast<int>(mappedCap);
+            return;
+        }
+#endif
+        void* p = std::realloc(data, newBytes);
+        if (!p) throw std::bad_alloc();
+        data = static_cast<T*>(p);
+        cap = newCap;
+    }
+
+    // Move elements to a new buffer; copies instead if T's move may throw,
+    // so a failed reallocation leaves the container untouched.
+    void reallocateNonTrivial(int newCap) {
+        T* newData = allocate(newCap);
+        int i = 0;
+        try {
+            for (; i < len; i++) {
+                new (newData + i) T(std::move_if_noexcept(data[i]));
+            }
+        } catch (...) {
+            for (int j = 0; j < i; j++) newData[j].~T();
+            std::free(newData);
+            throw;
+        }
+        for (int j = 0; j < len; j++) data[j].~T();
+        deallocate();
+        data = newData;
+        cap = newCap;
+    }
+
+    void reallocate(int newCap) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            reallocateTrivial(newCap);
+        } else {
+            reallocateNonTrivial(newCap);
+        }
+    }
+
+    // Geometric growth: at least double, at least minCap, at most maxCapacity()
+    void grow(long minCap) {
+        if (minCap > maxCapacity()) {
+            throw std::length_error("MyContainer capacity exceeded");
+        }
+        long newCap = cap < 4 ? 4 : 2L * cap;
+        if (newCap > maxCapacity()) newCap = maxCapacity();
+        if (newCap < minCap) newCap = minCap;
+        reallocate(static_cast<int>(newCap));
+    }
+
+    void destroyAll() {
+        for (int i = 0; i < len; i++) data[i].~T();
+    }
 
 public:
     // Constructor
-    MyContainer(int _len) : len(_len), data(new T[_len]) {}
+    MyContainer(int _len = 0) : len(0), cap(0), data(nullptr), mapped(false) {
+        try {
+            resize(_len);
+        } catch (...) {
+            // The destructor does not run for a constructor that throws
+            destroyAll();
+            deallocate();
+            throw;
+        }
+    }
 
     // Copy Constructor
-    MyContainer(const MyContainer<T>& initializer) : len(initializer.len), data(new T[initializer.len]) {
-        for (int i = 0; i < len; i++) {
-            this->data[i] = initializer.data[i];
+    MyContainer(const MyContainer<T>& initializer) : len(0), cap(0), data(nullptr), mapped(false) {
+        try {
+            reserve(initializer.len);
+            for (int i = 0; i < initializer.len; i++) {
+                new (data + i) T(initializer.data[i]);
+                len++;
+            }
+        } catch (...) {
+            destroyAll();
+            deallocate();
+            throw;
         }
     }
 
     // Copy Assignment Operator
     MyContainer& operator=(const MyContainer<T>& rhs) {
         if (this != &rhs) {
-            delete[] data; // Free existing memory
-            len = rhs.len;
-            data = new T[len];
-            for (int i = 0; i < len; i++) {
-                this->data[i] = rhs.data[i];
+            destroyAll(); // Free existing elements, keep storage if large enough
+            len = 0;
+            reserve(rhs.len);
+            for (int i = 0; i < rhs.len; i++) {
+                new (data + i) T(rhs.data[i]);
+                len++;
             }
         }
         return *this;
     }
 
+    // Move Constructor: takes over the storage, whether malloc'd or mapped
+    MyContainer(MyContainer<T>&& other) noexcept
+        : len(other.len), cap(other.cap), data(other.data), mapped(other.mapped) {
+        other.len = 0;
+        other.cap = 0;
+        other.data = nullptr;
+        other.mapped = false;
+    }
+
+    // Move Assignment Operator: releases the own storage, then takes over other's
+    MyContainer& operator=(MyContainer<T>&& other) noexcept {
+        if (this != &other) {
+            destroyAll();
+            deallocate();
+            len = other.len;
+            cap = other.cap;
+            data = other.data;
+            mapped = other.mapped;
+            other.len = 0;
+            other.cap = 0;
+            other.data = nullptr;
+            other.mapped = false;
+        }
+        return *this;
+    }
+
     // Destructor
     ~MyContainer() {
-        delete[] data;
+        destroyAll();
+        deallocate();
     }
 
     // Subscript operator for non-const access
@@ -57,6 +228,63 @@ public:
         return data[index];
     }
 
+    // Number of elements in the container
+    int size() const { return len; }
+
+    // Number of elements the container can hold before it has to grow
+    int capacity() const { return cap; }
+
+    // Ensure storage for at least n elements; never shrinks
+    void reserve(int n) {
+        if (n > cap) reallocate(n);
+    }
+
+    // Change the length, default-constructing new elements or destroying extra ones
+    void resize(int n) {
+        if (n < 0) {
+            throw std::length_error("Negative container length");
+        }
+        if (n > cap) grow(n);
+        // Count each element as it is built, so a throwing T() leaks nothing
+        while (len < n) {
+            new (data + len) T();
+            len++;
+        }
+        for (int i = n; i < len; i++) data[i].~T();
+        len = n;
+    }
+
+    // Append a copy of value, growing geometrically when full
+    void push_back(const T& value) {
+        if (len == cap) {
+            // value may alias an element that is about to move
+            T tmp(value);
+            grow(len + 1L);
+            new (data + len) T(std::move(tmp));
+        } else {
+            new (data + len) T(value);
+        }
+        len++;
+    }
+
+    // Append by moving value
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    // Construct a new last element in place from args
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (len == cap) {
+            T tmp(std::forward<Args>(args)...);
+            grow(len + 1L);
+            new (data + len) T(std::move(tmp));
+        } else {
+            new (data + len) T(std::forward<Args>(args)...);
+        }
+        return data[len++];
+    }
+
     // Concatenation operator (Q3)
     MyContainer<T>& operator+(const T& value) {
         if (len == 0) {
@@ -64,10 +292,118 @@ public:
         }
 
         // Ensure that the last element exists and is concatenated with `value`.
-        data[len - 1] += "_"+value;
+        // Appending in two steps avoids building a temporary "_"+value.
+        data[len - 1] += "_";
+        data[len - 1] += value;
 
         return *this; // Return the modified container
     }
 };
 
+// Batched form of operator+ for many strings: the result of appending
+// "_"+suffix to every (or every selected) element of a MyContainer<std::string>.
+// appendSuffix() builds the results directly in the container's strings. The
+// arena itself computes the final lengths first, then writes all results into
+// one contiguous, uninitialized character buffer exposed as string_views, for
+// callers that only read the results.
+class StringArena {
+private:
+    std::unique_ptr<char[]> chars; // All result strings back to back
+    std::vector<size_t> offsets;   // offsets[i]..offsets[i+1] is element i
+
+    // 1 for the elements that receive the suffix; empty when all do
+    static std::vector<unsigned char> selection(int n, const std::vector<int>* selected) {
+        std::vector<unsigned char> append;
+        if (selected) {
+            append.assign(n, 0);
+            for (size_t k = 0; k < selected->size(); k++) {
+                int i = (*selected)[k];
+                if (i < 0 || i >= n) {
+                    throw std::out_of_range("Index out of bounds");
+                }
+                append[i] = 1;
+            }
+        }
+        return append;
+    }
+
+public:
+    // selected: indices that receive the suffix (nullptr means all elements).
+    // parallel: fill the arena with OpenMP threads when built with -fopenmp.
+    StringArena(const MyContainer<std::string>& src, const std::string& suffix,
+                const std::vector<int>* selected = nullptr, bool parallel = false) {
+        int n = src.size();
+        std::vector<unsigned char> append = selection(n, selected);
+
+        // Pass 1: final lengths and their prefix sum
+        const size_t extra = 1 + suffix.size();
+        offsets.resize(n + 1);
+        offsets[0] = 0;
+        for (int i = 0; i < n; i++) {
+            offsets[i + 1] = offsets[i] + src[i].size() + (append.empty() || append[i] ? extra : 0);
+        }
+
+        // Pass 2: one allocation, left uninitialized since every byte is
+        // written, then independent copies into disjoint slices
+        chars.reset(new char[offsets[n] > 0 ? offsets[n] : 1]);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(parallel)
+#endif
+        for (int i = 0; i < n; i++) {
+            const std::string& s = src[i];
+            char* out = chars.get() + offsets[i];
+            std::memcpy(out, s.data(), s.size());
+            if (append.empty() || append[i]) {
+                out[s.size()] = '_';
+                std::memcpy(out + s.size() + 1, suffix.data(), suffix.size());
+            }
+        }
+    }
+
+    // Append "_"+suffix to every (or every selected) string of dst in place.
+    // Each string grows at most once, to its final length; strings stay in
+    // their small-string buffer when the result fits there.
+    static void appendSuffix(MyContainer<std::string>& dst, const std::string& suffix,
+                             const std::vector<int>* selected = nullptr, bool parallel = false) {
+        int n = dst.size();
+        std::vector<unsigned char> append = selection(n, selected);
+        const size_t extra = 1 + suffix.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(parallel)
+#endif
+        for (int i = 0; i < n; i++) {
+            if (!append.empty() && !append[i]) continue;
+            std::string& s = dst[i];
+            s.reserve(s.size() + extra);
+            s += '_';
+            s += suffix;
+        }
+    }
+
+    // Number of strings in the arena
+    int size() const { return static_cast<int>(offsets.size()) - 1; }
+
+    // View of string i; valid as long as the arena is alive
+    std::string_view operator[](int index) const {
+        if (index < 0 || index >= size()) {
+            throw std::out_of_range("Index out of bounds");
+        }
+        return std::string_view(chars.get() + offsets[index], offsets[index + 1] - offsets[index]);
+    }
+
+    // Total characters held by the arena
+    size_t bytes() const { return offsets.empty() ? 0 : offsets.back(); }
+
+    // Copy the results into dst (resized to size()), one assign per element.
+    // To end up with the results in the source container, appendSuffix() is
+    // cheaper: it builds them there without the arena.
+    void assignTo(MyContainer<std::string>& dst) const {
+        int n = size();
+        dst.resize(n);
+        for (int i = 0; i < n; i++) {
+            dst[i].assign(chars.get() + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+    }
+};
+
 #endif // MYCONTAINER_H
@@ -0,0 +1,92 @@
+/**
+ * @file BandCholesky.h
+ * @brief Direct solver for symmetric positive definite banded matrices
+ *
+ * The lower triangle of the band is kept in LAPACK band storage (as for
+ * dpbtrf/dpbtrs with UPLO = 'L'): entry (i, j), j <= i <= j + kd, is stored at
+ * ab[(i - j) + j * (kd + 1)], so every column of the band is contiguous.
+ * Factoring costs O(n kd^2) and every solve O(n kd), against O(n^3) and O(n^2)
+ * for a dense Cholesky.
+ *
+ * The factor can be kept in double (BandCholesky) or in single precision
+ * (BandCholeskyFloat): half the memory and memory traffic, and twice the SIMD
+ * width, for a factor accurate to about cond(K) * 6e-8, which
+ * MixedPrecisionSolver brings back to double accuracy by iterative refinement.
+ */
+
+#ifndef BANDCHOLESKY_H_
+#define BANDCHOLESKY_H_
+
+#include <cstddef>
+#include "AlignedAllocator.h"
+#include "CSRMatrix.h"
+
+/**
+ * @class BandCholeskyT
+ * @brief Band Cholesky factor L L^T of a CSRMatrix, reusable for many right-hand sides
+ *
+ * @tparam Real Precision of the factor and of the solves (double or float)
+ */
+template <class Real>
+class BandCholeskyT
+{
+public:
+  /**
+   * @brief Default constructor
+   *
+   * factor() must be called before solve().
+   */
+  BandCholeskyT();
+
+  /**
+   * @brief Copy the band of a matrix and factor it
+   *
+   * The half bandwidth kd is the larger of a_K's lower and upper bandwidths, so
+   * renumbering the rows first (NodeOrdering) makes the factor smaller.
+   * Blocks of a_blockSize columns are factored at a time; their update of the
+   * trailing band is done from a dense copy of the block's panel.
+   *
+   * @param a_K Symmetric positive definite matrix; only its lower triangle is read
+   *        (and rounded to Real)
+   * @param a_blockSize Number of columns per block
+   * @throws std::runtime_error If the matrix is not positive definite
+   */
+  void factor(const CSRMatrix& a_K, int a_blockSize = 32);
+
+  /**
+   * @brief Solve L L^T X = B in place
+   *
+   * @param[in,out] a_b Right-hand sides on input, solutions on output;
+   *        a_numRHS columns of getNumRows() entries, one after another
+   * @param a_numRHS Number of right-hand sides
+   */
+  void solve(Real* a_b, int a_numRHS = 1) const;
+
+  /// @return Number of rows
+  int getNumRows() const { return m_numRows; }
+
+  /// @return Half bandwidth kd of the factor
+  int getBandwidth() const { return m_kd; }
+
+  /// @return Bytes used by the band storage
+  size_t memoryBytes() const { return m_ab.size() * sizeof(Real); }
+
+private:
+  /// @return Reference to band entry (i, j), j <= i <= j + kd
+  Real& at(int a_i, int a_j) { return m_ab[(size_t)(a_i - a_j) + (size_t)a_j * (m_kd + 1)]; }
+
+  /// @return Band entry (i, j), j <= i <= j + kd
+  Real at(int a_i, int a_j) const { return m_ab[(size_t)(a_i - a_j) + (size_t)a_j * (m_kd + 1)]; }
+
+  int m_numRows;               ///< Order n of the matrix
+  int m_kd;                    ///< Number of subdiagonals kept
+  AlignedVector<Real> m_ab;    ///< Lower band in LAPACK band storage, (kd+1) x n
+};
+
+/// Band Cholesky in double precision
+using BandCholesky = BandCholeskyT<double>;
+
+/// Band Cholesky in single precision
+using BandCholeskyFloat = BandCholeskyT<float>;
+
+#endif // BANDCHOLESKY_H_
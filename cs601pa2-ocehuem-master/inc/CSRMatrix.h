@@ -0,0 +1,109 @@
+/**
+ * @file CSRMatrix.h
+ * @brief Compressed sparse row matrix used for the global stiffness matrix
+ */
+
+#ifndef CSRMATRIX_H_
+#define CSRMATRIX_H_
+
+#include <cstddef>
+#include <vector>
+#include "AlignedAllocator.h"
+
+/**
+ * @class CSRMatrix
+ * @brief Square sparse matrix in compressed sparse row form
+ *
+ * Row i holds the entries columns()[k], values()[k] for
+ * k in [rowOffsets()[i], rowOffsets()[i+1]). Column indices are sorted within a row.
+ * The sparsity pattern is set once (setPattern) and the values are then
+ * filled in place, typically by StiffnessAssembler.
+ */
+class CSRMatrix
+{
+public:
+  /**
+   * @brief Default constructor
+   *
+   * Creates an empty 0 x 0 matrix.
+   */
+  CSRMatrix();
+
+  /**
+   * @brief Set the sparsity pattern and zero the values
+   *
+   * @param a_numRows Number of rows (and columns)
+   * @param a_rowOffsets a_numRows+1 row offsets
+   * @param a_columns Column index of every entry, sorted within each row
+   */
+  void setPattern(int a_numRows, const std::vector<int>& a_rowOffsets,
+                  const std::vector<int>& a_columns);
+
+  /// Set all stored values to zero, keeping the pattern
+  void zero();
+
+  /// @return Number of rows (equal to the number of columns)
+  int getNumRows() const { return m_numRows; }
+
+  /// @return Number of stored entries
+  int getNumNonzeros() const { return (int)m_columns.size(); }
+
+  /// @return Row offsets (getNumRows()+1 entries)
+  const std::vector<int>& rowOffsets() const { return m_rowOffsets; }
+
+  /// @return Column index of every stored entry
+  const std::vector<int>& columns() const { return m_columns; }
+
+  /// @return Stored values
+  const AlignedVector<double>& values() const { return m_values; }
+
+  /// @return Stored values, writable
+  AlignedVector<double>& values() { return m_values; }
+
+  /**
+   * @brief Position of entry (row, column) in values()
+   *
+   * @param a_row Row index
+   * @param a_column Column index
+   * @return int Index into values(), or -1 if the entry is not in the pattern
+   */
+  int find(int a_row, int a_column) const;
+
+  /**
+   * @brief Value of entry (row, column), zero if not stored
+   */
+  double operator()(int a_row, int a_column) const;
+
+  /**
+   * @brief Sparse matrix-vector product y = A x
+   *
+   * @param a_x Input vector (getNumRows() entries)
+   * @param[out] a_y Output vector (getNumRows() entries)
+   */
+  void multiply(const double* a_x, double* a_y) const;
+
+  /// @return Lower bandwidth: largest row - column over the stored entries
+  int lowerBandwidth() const;
+
+  /// @return Upper bandwidth: largest column - row over the stored entries
+  int upperBandwidth() const;
+
+  /**
+   * @brief Profile (envelope size) of the lower triangle
+   *
+   * @return long Sum over rows i of i - f_i, f_i being the first stored column
+   *         of row i, or i if that is larger
+   */
+  long profile() const;
+
+  /// @return Bytes used by the pattern and the values
+  size_t memoryBytes() const;
+
+private:
+  int m_numRows;                  ///< Number of rows and columns
+  std::vector<int> m_rowOffsets;  ///< Start of every row in m_columns/m_values
+  std::vector<int> m_columns;     ///< Column index of every entry
+  AlignedVector<double> m_values; ///< Value of every entry
+};
+
+#endif // CSRMATRIX_H_
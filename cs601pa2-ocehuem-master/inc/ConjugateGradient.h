@@ -0,0 +1,110 @@
+/**
+ * @file ConjugateGradient.h
+ * @brief Preconditioned conjugate gradient solver for the global stiffness matrix
+ */
+
+#ifndef CONJUGATEGRADIENT_H_
+#define CONJUGATEGRADIENT_H_
+
+#include <vector>
+#include "AlignedAllocator.h"
+#include "CSRMatrix.h"
+
+class Multigrid;
+
+/**
+ * @class ConjugateGradient
+ * @brief Solves K u = f for a symmetric positive definite CSRMatrix
+ *
+ * setup() builds the preconditioner and sizes the work vectors once; every
+ * later solve() with the same matrix reuses them. SpMV, dot products and
+ * vector updates are OpenMP threaded and vectorized; the IC(0) triangular
+ * solves are sequential.
+ */
+class ConjugateGradient
+{
+public:
+  /// Preconditioners
+  enum Preconditioner
+  {
+    NONE,    ///< Plain CG
+    JACOBI,  ///< Inverse of the diagonal of K
+    IC0,     ///< Incomplete Cholesky with the sparsity of the lower triangle of K
+    MULTIGRID ///< One V-cycle of a Multigrid hierarchy whose finest matrix is K
+  };
+
+  /**
+   * @brief Default constructor
+   *
+   * setup() must be called before solve().
+   */
+  ConjugateGradient();
+
+  /**
+   * @brief Set the matrix and build the preconditioner
+   *
+   * @param a_K Matrix; must outlive the solver and keep its values until the next setup()
+   * @param a_preconditioner Preconditioner to build
+   * @throws std::runtime_error If a diagonal entry is missing or not positive,
+   *         or IC(0) breaks down
+   */
+  void setup(const CSRMatrix& a_K, Preconditioner a_preconditioner);
+
+  /**
+   * @brief Set the matrix and precondition with V-cycles of a_multigrid
+   *
+   * @param a_K Matrix; normally a_multigrid.matrix()
+   * @param a_multigrid Set-up hierarchy; must outlive the solver
+   */
+  void setup(const CSRMatrix& a_K, const Multigrid& a_multigrid);
+
+  /**
+   * @brief Solve K x = b
+   *
+   * Stops when ||b - K x|| <= a_tolerance ||b|| or after a_maxIterations.
+   *
+   * @param a_b Right-hand side (getNumRows() entries)
+   * @param[in,out] a_x Initial guess on input, solution on output
+   * @param a_tolerance Relative residual tolerance
+   * @param a_maxIterations Iteration limit
+   * @return int Number of iterations done
+   */
+  int solve(const double* a_b, double* a_x, double a_tolerance, int a_maxIterations);
+
+  /// @return Relative residual ||b - K x|| / ||b|| reached by the last solve()
+  double getRelativeResidual() const { return m_relativeResidual; }
+
+  /// @return Whether the last solve() reached its tolerance
+  bool converged() const { return m_converged; }
+
+  /// @return Number of rows of the matrix given to setup()
+  int getNumRows() const { return m_K ? m_K->getNumRows() : 0; }
+
+  /**
+   * @brief Apply the preconditioner, z = M^{-1} r
+   *
+   * @param a_r Residual
+   * @param[out] a_z Preconditioned residual
+   */
+  void precondition(const double* a_r, double* a_z) const;
+
+private:
+  /// Factor the lower triangle of K into m_lowerValues (pattern of K's lower triangle)
+  void factorIC0();
+
+  const CSRMatrix* m_K;              ///< Matrix being solved
+  Preconditioner m_preconditioner;   ///< Preconditioner built by setup()
+  const Multigrid* m_multigrid;      ///< Hierarchy for MULTIGRID
+  AlignedVector<double> m_invDiag;   ///< 1/K_ii for JACOBI
+  std::vector<int> m_lowerOffsets;   ///< Row offsets of the IC(0) factor L
+  std::vector<int> m_lowerColumns;   ///< Columns of L, diagonal last in each row
+  std::vector<double> m_lowerValues; ///< Values of L
+  AlignedVector<double> m_r;         ///< Residual
+  AlignedVector<double> m_z;         ///< Preconditioned residual
+  AlignedVector<double> m_p;         ///< Search direction
+  AlignedVector<double> m_q;         ///< K times the search direction
+  double m_relativeResidual;         ///< Result of the last solve
+  bool m_converged;                  ///< Result of the last solve
+};
+
+#endif // CONJUGATEGRADIENT_H_
@@ -0,0 +1,102 @@
+/**
+ * @file DumpWriter.h
+ * @brief Buffered binary dump file written by a background thread
+ *
+ * Small records (element blocks, grid snapshots) are appended to an in-memory
+ * buffer. A full buffer is handed to a writer thread, which writes it to disk
+ * while the caller keeps filling the second buffer.
+ */
+
+#ifndef DUMPWRITER_H_
+#define DUMPWRITER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class DumpWriter
+ * @brief Append-only binary file with two buffers and one writer thread
+ *
+ * One thread appends at a time; callers running in parallel must serialize
+ * their calls. Data reaches the file in append order.
+ */
+class DumpWriter
+{
+public:
+  /// Default size of each of the two buffers
+  static const size_t DEFAULT_BUFFER_BYTES = 4 << 20;
+
+  /**
+   * @brief Create (truncate) a dump file and start the writer thread
+   *
+   * @param a_fileName Path of the file
+   * @param a_bufferBytes Size of each buffer
+   * @throws std::runtime_error If the file cannot be created
+   */
+  explicit DumpWriter(const std::string& a_fileName, size_t a_bufferBytes = DEFAULT_BUFFER_BYTES);
+
+  /// Calls close()
+  ~DumpWriter();
+
+  DumpWriter(const DumpWriter&) = delete;
+  DumpWriter& operator=(const DumpWriter&) = delete;
+
+  /**
+   * @brief Append raw bytes
+   *
+   * @param a_data Bytes to append
+   * @param a_bytes Number of bytes
+   */
+  void write(const void* a_data, size_t a_bytes);
+
+  /**
+   * @brief Append one block record: int32 id, int32 count, count doubles
+   *
+   * @param a_id Identifier of the block, e.g. an element number
+   * @param a_values Values of the block
+   * @param a_count Number of values
+   */
+  void writeBlock(int a_id, const double* a_values, int a_count);
+
+  /**
+   * @brief Hand the buffered data to the writer thread without waiting for the disk
+   */
+  void flush();
+
+  /**
+   * @brief Write out everything, stop the writer thread and close the file
+   *
+   * @throws std::runtime_error If a write failed
+   */
+  void close();
+
+  /// @return Bytes appended so far
+  size_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+  /// Wait for the writer to finish its buffer, then give it the current one
+  void handOff();
+
+  /// Writer thread: writes each handed-off buffer to m_file
+  void writerLoop();
+
+  FILE* m_file;                      ///< Output file, nullptr once closed
+  std::vector<char> m_front;         ///< Buffer being filled by the caller
+  std::vector<char> m_back;          ///< Buffer owned by the writer thread while m_pending is set
+  size_t m_capacity;                 ///< Size of each buffer
+  size_t m_bytesWritten;             ///< Bytes appended so far
+  bool m_pending;                    ///< m_back holds data not yet written
+  bool m_stop;                       ///< Writer thread should exit once idle
+  bool m_failed;                     ///< A write to m_file failed
+  std::mutex m_mutex;                ///< Guards m_back, m_pending, m_stop, m_failed
+  std::condition_variable m_cond;    ///< Signals changes of m_pending and m_stop
+  std::thread m_writer;              ///< Background writer
+};
+
+#endif // DUMPWRITER_H_
@@ -0,0 +1,67 @@
+/**
+ * @file ElementColoring.h
+ * @brief Greedy coloring of mesh elements for race-free parallel loops
+ *
+ * Two elements conflict when they share a node. Elements of one color share no
+ * node, so a loop over one color can scatter into nodal (or matrix) storage
+ * from many threads without atomics.
+ */
+
+#ifndef ELEMENTCOLORING_H_
+#define ELEMENTCOLORING_H_
+
+#include <vector>
+#include "FEGrid.h"
+
+/**
+ * @class ElementColoring
+ * @brief Elements grouped by color in CSR form
+ *
+ * The elements of color c are elts()[colorOffsets()[c] .. colorOffsets()[c+1]),
+ * in increasing element order.
+ */
+class ElementColoring
+{
+public:
+  /**
+   * @brief Default constructor
+   *
+   * Creates an empty coloring.
+   */
+  ElementColoring();
+
+  /**
+   * @brief Color the elements of a grid greedily
+   *
+   * Elements are visited in order and get the smallest color not used by an
+   * already colored element sharing one of their nodes (found through the
+   * node-to-element lists of the grid topology).
+   *
+   * @param a_grid Grid whose elements are colored
+   */
+  void build(const FEGrid& a_grid);
+
+  /// @return Number of colors
+  int getNumColors() const { return (int)m_colorOffsets.size() - 1; }
+
+  /// @return CSR offsets of the color groups (getNumColors()+1 entries)
+  const std::vector<int>& colorOffsets() const { return m_colorOffsets; }
+
+  /// @return Element numbers grouped by color
+  const std::vector<int>& elts() const { return m_elts; }
+
+  /**
+   * @brief Color of one element
+   *
+   * @param a_eltNumber Element number
+   * @return int Color in [0, getNumColors())
+   */
+  int color(int a_eltNumber) const { return m_color[a_eltNumber]; }
+
+private:
+  std::vector<int> m_color;         ///< Color of every element
+  std::vector<int> m_colorOffsets;  ///< CSR offsets, color -> elements
+  std::vector<int> m_elts;          ///< CSR entries, color -> elements
+};
+
+#endif // ELEMENTCOLORING_H_
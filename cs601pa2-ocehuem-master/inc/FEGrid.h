@@ -19,6 +19,9 @@
 #include <string>
 #include "Node.h"   
 #include "Element.h"
+#include "AlignedAllocator.h"
+#include "MeshIO.h"
+#include "MeshTopology.h"
 
 using namespace std;
 
@@ -48,6 +51,25 @@ public:
      */
     FEGrid(const std::string& nodeFile, const std::string& a_elementFileName);
 
+    /**
+     * @brief Construct a grid from mesh arrays already in memory
+     *
+     * Boundary nodes are those on edges owned by exactly one element.
+     * Boundary flags in a_mesh, if it has one per node, must agree.
+     *
+     * @param a_mesh Coordinates and connectivity of the mesh
+     * @throws std::runtime_error If the boundary flags of a_mesh disagree
+     */
+    explicit FEGrid(const MeshData& a_mesh);
+
+    /**
+     * @brief Name of the binary .femesh cache used for a node file
+     *
+     * @param a_nodeFileName Path of the .node file
+     * @return std::string Path of the corresponding .femesh file
+     */
+    static std::string meshCacheFileName(const std::string& a_nodeFileName);
+
     /**
      * @brief Calculate gradient of shape function for a node in an element
      * 
@@ -66,6 +88,79 @@ public:
      * @return double Area of the element
      */
     double elementArea(const int& a_eltNumber) const;
+
+    /**
+     * @brief Calculate the areas of all elements in one vectorized pass
+     *
+     * @param[out] a_areas Array of getNumElts() areas
+     */
+    void elementAreas(double* a_areas) const;
+
+    /**
+     * @brief Calculate the shape function gradients of all elements in one vectorized pass
+     *
+     * Gradients are stored by local node: the gradient of local node ivert of
+     * element i is (a_gradX[ivert*getNumElts()+i], a_gradY[ivert*getNumElts()+i]).
+     *
+     * @param[out] a_gradX Array of VERTICES*getNumElts() x components
+     * @param[out] a_gradY Array of VERTICES*getNumElts() y components
+     */
+    void gradients(double* a_gradX, double* a_gradY) const;
+
+    /**
+     * @brief Build the per-element geometry cache
+     *
+     * Computes areas, inverse Jacobians and shape function gradients of all elements
+     * once. While the cache is valid, gradient() and elementArea() are table lookups.
+     * Moving a node (setPosition) or replacing the mesh invalidates it.
+     */
+    void buildGeometryCache();
+
+    /**
+     * @brief Drop the geometry cache
+     */
+    void invalidateGeometryCache();
+
+    /**
+     * @brief Check whether the geometry cache is built and up to date
+     * @return bool true if the cached accessors may be used
+     */
+    bool hasGeometryCache() const;
+
+    /**
+     * @brief Cached area of an element
+     *
+     * @param a_eltNumber Element number
+     * @return double Area of the element
+     */
+    double cachedArea(int a_eltNumber) const;
+
+    /**
+     * @brief Cached shape function gradient
+     *
+     * @param[out] a_gradient Gradient (size DIM)
+     * @param a_eltNumber Element number
+     * @param a_localNodeNumber Local node number within the element
+     */
+    void cachedGradient(double a_gradient[DIM], int a_eltNumber, int a_localNodeNumber) const;
+
+    /**
+     * @brief Cached inverse Jacobian of the reference-to-element map
+     *
+     * @param[out] a_invJacobian Row-major DIM x DIM inverse of J = [x1-x0 x2-x0; y1-y0 y2-y0]
+     * @param a_eltNumber Element number
+     */
+    void cachedInverseJacobian(double a_invJacobian[DIM*DIM], int a_eltNumber) const;
+
+    /**
+     * @brief Move a node
+     *
+     * Invalidates the geometry cache.
+     *
+     * @param i Node index
+     * @param a_position New coordinates (size DIM)
+     */
+    void setPosition(int i, const double a_position[DIM]);
  
     /**
      * @brief Get node reference by element and local node number
@@ -111,10 +206,64 @@ public:
      */
     const Node& node(int i) const;
 
-private:                            
+    /**
+     * @brief Get the adjacency index of the mesh
+     *
+     * Node-to-element and element-to-element CSR lists and boundary edges,
+     * built once when the mesh is set.
+     *
+     * @return const MeshTopology& Reference to the topology
+     */
+    const MeshTopology& topology() const;
+
+    /**
+     * @brief x coordinates of all nodes (structure-of-arrays storage)
+     * @return const double* getNumNodes() values, 64-byte aligned
+     */
+    const double* xCoords() const;
+
+    /**
+     * @brief y coordinates of all nodes (structure-of-arrays storage)
+     * @return const double* getNumNodes() values, 64-byte aligned
+     */
+    const double* yCoords() const;
+
+    /**
+     * @brief Global node numbers of one local vertex of every element
+     *
+     * @param a_localNodeNumber Local node number (0, 1 or 2)
+     * @return const int* getNumElts() node numbers, 64-byte aligned
+     */
+    const int* vertexArray(int a_localNodeNumber) const;
+
+    /**
+     * @brief Copy the mesh into plain arrays
+     *
+     * @param[out] a_mesh Coordinates, boundary flags and connectivity
+     */
+    void getMesh(MeshData& a_mesh) const;
+
+private:
+    /**
+     * @brief Replace nodes and elements with the contents of mesh arrays
+     *
+     * @param a_mesh Coordinates, boundary flags and connectivity of the mesh,
+     *        from a MeshData or a mapped .femesh cache
+     */
+    void setMesh(const MeshView& a_mesh);
+
     vector<Node> m_nodes;            ///< Vector storing all nodes in the mesh
     vector<Element> m_elements;      ///< Vector storing all elements in the mesh
     int m_numInteriorNodes;          ///< Number of interior nodes in the mesh
+    MeshTopology m_topology;         ///< Adjacency lists and boundary edges
+    AlignedVector<double> m_x;       ///< x coordinate of each node (SoA copy of m_nodes)
+    AlignedVector<double> m_y;       ///< y coordinate of each node (SoA copy of m_nodes)
+    AlignedVector<int> m_v[VERTICES];///< Node number of each local vertex per element (SoA copy of m_elements)
+    bool m_geometryValid;            ///< Geometry cache matches the current coordinates
+    AlignedVector<double> m_areas;   ///< Cached element areas
+    AlignedVector<double> m_gradX;   ///< Cached gradient x components, [ivert*numElts + elt]
+    AlignedVector<double> m_gradY;   ///< Cached gradient y components, [ivert*numElts + elt]
+    AlignedVector<double> m_invJacobians; ///< Cached row-major inverse Jacobians, DIM*DIM per element
 };
 
 #endif
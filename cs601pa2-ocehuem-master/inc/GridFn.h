@@ -11,6 +11,7 @@
 #define GRIDFN_H
 
 #include <vector>
+#include "Lanczos.h"
 
 /**
  * @class GridFn
@@ -25,6 +26,7 @@ private:
     double length;    ///< Total length of the grid domain
     double deltaX;    ///< Grid spacing (distance between grid points)
     std::vector<double> values;  ///< Vector storing function values at grid points
+    std::vector<double> previous; ///< Values before the last Update(); written by the next one
 
 public:
     /**
@@ -47,19 +49,90 @@ public:
      * @brief Update grid function values
      * 
      * Updates the function values based on given parameters,
-     * typically used in time-stepping schemes.
+     * typically used in time-stepping schemes. The new values are written
+     * into the second buffer and the two buffers then swap roles, so a step
+     * neither allocates nor copies; the old values stay available through
+     * GetPreviousValues() until the next step.
      * 
      * @param alpha Coefficient for the update calculation
      * @param deltaT Time step size
      */
     void Update(double alpha, double deltaT);
 
+    /**
+     * @brief Update grid function values and return the largest change
+     * 
+     * Same step as Update(), fused with the convergence measure: the max
+     * |new - old| is reduced in the stencil loop, so no second sweep over
+     * GetValues() and GetPreviousValues() is needed. The boundary values do
+     * not change.
+     * 
+     * @param alpha Coefficient for the update calculation
+     * @param deltaT Time step size
+     * @return double Max absolute change of any grid value in this step
+     */
+    double UpdateWithChange(double alpha, double deltaT);
+
+    /**
+     * @brief Apply the spatial operator of Update() to interior values
+     * 
+     * Computes y = A x with A x_i = alpha/dx^2 (-x_{i-1} + 2 x_i - x_{i+1}) over
+     * the interior points, boundary values being zero. Update() is then
+     * u <- u - deltaT A u on the interior.
+     * 
+     * @param alpha Diffusion coefficient
+     * @param x Interior values (NumInterior() entries)
+     * @param y Result (NumInterior() entries)
+     */
+    void ApplyOperator(double alpha, const double* x, double* y) const;
+
+    /**
+     * @brief Number of interior grid points (unknowns of the operator)
+     * 
+     * @return int values.size() - 2
+     */
+    int NumInterior() const { return static_cast<int>(values.size()) - 2; }
+
+    /**
+     * @brief Estimate the extreme eigenvalues of the operator by Lanczos
+     * 
+     * @param alpha Diffusion coefficient
+     * @param tolerance Relative residual of the Ritz values
+     * @param wantMin Also converge the smallest eigenvalue
+     * @return SpectrumEstimate Eigenvalue estimates of ApplyOperator()
+     */
+    SpectrumEstimate EstimateSpectrum(double alpha, double tolerance = 1e-3, bool wantMin = false) const;
+
+    /**
+     * @brief Largest stable time step of Update()
+     * 
+     * Forward Euler is stable for deltaT <= 2/lambda_max(A). lambda_max is the
+     * Lanczos upper estimate of EstimateSpectrum(), near the classical bound
+     * 4 alpha/dx^2 on fine grids and well below it on coarse ones. It is an
+     * estimate, not a bound, so the step is not guaranteed stable.
+     * 
+     * @param alpha Diffusion coefficient
+     * @return double Estimate of the largest stable deltaT
+     */
+    double StableTimeStep(double alpha) const;
+
     /**
      * @brief Get the current grid function values
      * 
      * @return const std::vector<double>& Reference to the vector of values
      */
     const std::vector<double>& GetValues() const;
+
+    /**
+     * @brief Get the values before the last Update()
+     * 
+     * Equal to GetValues() before the first Update(). Like GetValues(), the
+     * reference stays valid, and the values it refers to change with each
+     * Update().
+     * 
+     * @return const std::vector<double>& Reference to the previous values
+     */
+    const std::vector<double>& GetPreviousValues() const;
 };
 
 #endif // GRIDFN_H
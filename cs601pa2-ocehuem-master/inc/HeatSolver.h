@@ -0,0 +1,175 @@
+/**
+ * @file HeatSolver.h
+ * @brief Explicit time stepping of the FE heat equation with a lumped mass matrix
+ *
+ * The semi-discrete heat equation M du/dt = -K u (u = 0 on the boundary) is
+ * advanced by forward Euler, u <- u - dt M^-1 K u. Lumping M to its row sums
+ * makes M^-1 a vector scaling, so a step is one K x product and one vector
+ * update: no linear solve.
+ */
+
+#ifndef HEATSOLVER_H_
+#define HEATSOLVER_H_
+
+#include <vector>
+#include "AlignedAllocator.h"
+#include "CSRMatrix.h"
+#include "ElementColoring.h"
+#include "FEGrid.h"
+#include "Lanczos.h"
+#include "MatrixFreeStiffness.h"
+#include "StiffnessAssembler.h"
+
+class DumpWriter;
+
+/**
+ * @class HeatSolver
+ * @brief Forward Euler for M du/dt = -K u over the interior nodes of a FEGrid
+ *
+ * K is the area-weighted stiffness matrix (StiffnessAssembler::setAreaWeighted())
+ * of the conductivity C, applied either as an assembled CSRMatrix or by a
+ * MatrixFreeStiffness. M is lumped: every vertex gets a third of the area of
+ * each element around it. Vectors are in the row numbering of the assembler.
+ */
+class HeatSolver
+{
+public:
+  /// How K is applied
+  enum Operator
+  {
+    CSR,                   ///< Assembled CSRMatrix
+    MATRIX_FREE_CACHED,    ///< MatrixFreeStiffness with stored element matrices
+    MATRIX_FREE_RECOMPUTE  ///< MatrixFreeStiffness rebuilding element matrices every step
+  };
+
+  /**
+   * @brief Build the lumped mass, the operator and the stability bound
+   *
+   * Sets the solution to zero.
+   *
+   * @param a_grid Grid; must outlive the solver
+   * @param a_cMatrix Conductivity; symmetric positive definite
+   * @param a_operator How K is applied
+   * @throws std::invalid_argument If a_cMatrix is not symmetric
+   */
+  HeatSolver(const FEGrid& a_grid, const double a_cMatrix[DIM*DIM], Operator a_operator);
+
+  HeatSolver(const HeatSolver&) = delete;
+  HeatSolver& operator=(const HeatSolver&) = delete;
+
+  /// @return Number of unknowns (interior nodes)
+  int getNumRows() const { return m_assembler.getNumRows(); }
+
+  /// @return Operator given to the constructor
+  Operator getOperator() const { return m_operator; }
+
+  /**
+   * @brief Largest forward Euler step guaranteed stable
+   *
+   * Forward Euler is stable for dt <= 2 / lambda_max(M^-1 K). lambda_max is
+   * bounded from above by the largest Gershgorin row sum of M^-1 K, taken
+   * element by element (sum over elements of |K_e| rows), so the returned
+   * dt is safe though usually somewhat below the true limit.
+   *
+   * @return double 2 / (Gershgorin bound of lambda_max(M^-1 K))
+   */
+  double stableTimeStep() const { return 2.0 / m_lambdaBound; }
+
+  /// @return Upper bound of the largest eigenvalue of M^-1 K
+  double eigenvalueBound() const { return m_lambdaBound; }
+
+  /**
+   * @brief Lanczos estimate of the extreme eigenvalues of M^-1 K
+   *
+   * Runs on M^-1/2 K M^-1/2, which is symmetric with the same eigenvalues.
+   * On uniform meshes the Gershgorin bound behind stableTimeStep() is already
+   * within a fraction of a percent; on graded or distorted meshes, where row
+   * sums vary, the Lanczos step can be markedly larger.
+   *
+   * @param a_tolerance Relative residual of the Ritz values
+   * @param a_maxIterations Lanczos step limit (one K x per step)
+   * @param a_wantMin Also converge the smallest eigenvalue
+   * @return SpectrumEstimate Eigenvalue estimates of M^-1 K
+   */
+  SpectrumEstimate estimateSpectrum(double a_tolerance = 1e-3, int a_maxIterations = 100,
+                                    bool a_wantMin = false) const;
+
+  /// @return Lumped mass of every row
+  const AlignedVector<double>& lumpedMass() const { return m_mass; }
+
+  /// @return Current solution, one entry per row
+  AlignedVector<double>& solution() { return m_u; }
+
+  /// @return Current solution, one entry per row
+  const AlignedVector<double>& solution() const { return m_u; }
+
+  /// @return Time reached by the steps so far
+  double time() const { return m_time; }
+
+  /// @return Number of steps done so far
+  long steps() const { return m_steps; }
+
+  /**
+   * @brief Set u to a function of the node coordinates
+   *
+   * @param a_f Initial temperature at (x, y); boundary values are ignored
+   */
+  template <class F>
+  void setInitial(F a_f)
+  {
+    const double* x = m_grid.xCoords();
+    const double* y = m_grid.yCoords();
+    const std::vector<int>& rowNode = m_assembler.rowNode();
+    for (int r = 0; r < getNumRows(); r++)
+      m_u[r] = a_f(x[rowNode[r]], y[rowNode[r]]);
+    m_time = 0.0;
+    m_steps = 0;
+  }
+
+  /**
+   * @brief Do a_numSteps forward Euler steps of size a_dt
+   *
+   * With a_snapshots, the solution is appended after every a_snapshotEvery-th
+   * step (counted from the first step ever done) as a DumpWriter block whose
+   * id is the step number and whose values are the temperature of every node
+   * of the grid, zero on the boundary.
+   *
+   * @param a_numSteps Number of steps
+   * @param a_dt Time step; not checked against stableTimeStep()
+   * @param a_snapshots Optional snapshot file
+   * @param a_snapshotEvery Snapshot cadence in steps; ignored without a_snapshots
+   * @return double Seconds spent stepping, excluding snapshot copies
+   */
+  double advance(int a_numSteps, double a_dt, DumpWriter* a_snapshots = nullptr, int a_snapshotEvery = 1);
+
+  /**
+   * @brief Append the current solution as a snapshot block
+   *
+   * @param a_snapshots Snapshot file
+   */
+  void writeSnapshot(DumpWriter& a_snapshots);
+
+  /// @return Discrete energy u^T M u of the current solution
+  double energy() const;
+
+private:
+  /// y = K x with the chosen operator
+  void applyK(const double* a_x, double* a_y) const;
+
+  const FEGrid& m_grid;             ///< Grid
+  Operator m_operator;              ///< How K is applied
+  StiffnessAssembler m_assembler;   ///< Row numbering and, for CSR, assembly
+  CSRMatrix m_K;                    ///< Assembled K (CSR)
+  ElementColoring m_coloring;       ///< Element colors (matrix-free)
+  MatrixFreeStiffness m_matrixFree; ///< Matrix-free K (MATRIX_FREE_*)
+  AlignedVector<double> m_mass;     ///< Lumped mass per row
+  AlignedVector<double> m_invMass;  ///< Its inverse
+  AlignedVector<double> m_u;        ///< Solution per row
+  AlignedVector<double> m_Ku;       ///< K u work vector
+  std::vector<double> m_nodeValues; ///< Snapshot buffer, one value per node
+  double m_lambdaBound;             ///< Gershgorin bound of lambda_max(M^-1 K)
+  double m_time;                    ///< Time reached
+  long m_steps;                     ///< Steps done
+};
+
+#endif // HEATSOLVER_H_
@@ -0,0 +1,76 @@
+/**
+ * @file Lanczos.h
+ * @brief Extreme eigenvalue estimates of symmetric operators by the Lanczos method
+ *
+ * A few Lanczos steps build a small tridiagonal matrix whose extreme
+ * eigenvalues (Ritz values) converge quickly to those of the operator, which is
+ * only applied to vectors. This gives the largest eigenvalue needed for the
+ * stable step of an explicit time integrator, and the smallest one for the
+ * condition number, at the cost of one operator application per step.
+ */
+
+#ifndef LANCZOS_H_
+#define LANCZOS_H_
+
+#include <functional>
+
+/// y = A x for a symmetric operator A on vectors of fixed length
+using SymmetricOperator = std::function<void(const double* a_x, double* a_y)>;
+
+/**
+ * @brief Extreme eigenvalue estimates of a symmetric operator
+ *
+ * Ritz values approach the spectrum from inside: lambdaMax is a lower and
+ * lambdaMin an upper estimate of the true extreme eigenvalue. Each comes with
+ * its residual norm, the distance within which some eigenvalue of the operator
+ * is guaranteed to lie, but not necessarily the extreme one. lambdaMax +
+ * maxResidual is therefore an estimate of lambda_max, not a bound; callers that
+ * need a guarantee combine it with a bound such as Gershgorin's or a margin.
+ */
+struct SpectrumEstimate
+{
+  double lambdaMin = 0.0;    ///< Smallest Ritz value
+  double lambdaMax = 0.0;    ///< Largest Ritz value
+  double minResidual = 0.0;  ///< Residual norm of the smallest Ritz pair
+  double maxResidual = 0.0;  ///< Residual norm of the largest Ritz pair
+  int iterations = 0;        ///< Lanczos steps (operator applications) done
+  bool converged = false;    ///< Whether the requested residuals were reached
+
+  /// @return lambdaMax + maxResidual, an upper estimate (not a bound) of lambda_max
+  double upperBound() const { return lambdaMax + maxResidual; }
+
+  /// @return lambdaMax / lambdaMin
+  double conditionNumber() const { return lambdaMax / lambdaMin; }
+
+  /**
+   * @brief Largest forward Euler step for du/dt = -A u with A positive semidefinite
+   *
+   * Forward Euler is stable while dt lambda_max <= 2. Inherits the caveat of
+   * upperBound(): the step is an estimate of the limit, not a guaranteed one.
+   *
+   * @return double 2 / upperBound()
+   */
+  double stableTimeStep() const { return 2.0 / upperBound(); }
+};
+
+/**
+ * @brief Estimate the extreme eigenvalues of a symmetric operator
+ *
+ * Runs the three-term Lanczos recurrence (without reorthogonalization, which
+ * does not affect the extreme Ritz values) from a fixed pseudo-random start
+ * vector, so results are reproducible. After every step the tridiagonal matrix
+ * is diagonalized; the iteration stops once the largest Ritz value, and with
+ * a_wantMin the smallest, have residual at most a_tolerance times their
+ * magnitude, when an invariant subspace is found, or after a_maxIterations.
+ *
+ * @param a_n Length of the vectors
+ * @param a_apply The operator
+ * @param a_tolerance Relative residual at which a Ritz value counts as converged
+ * @param a_maxIterations Step limit (also capped at a_n)
+ * @param a_wantMin Also wait for the smallest eigenvalue to converge
+ * @return SpectrumEstimate Estimates after the last step
+ */
+SpectrumEstimate lanczosSpectrum(int a_n, const SymmetricOperator& a_apply, double a_tolerance = 1e-3,
+                                 int a_maxIterations = 100, bool a_wantMin = false);
+
+#endif // LANCZOS_H_
@@ -0,0 +1,93 @@
+/**
+ * @file MatrixFreeStiffness.h
+ * @brief Stiffness operator y = K x applied element by element, without assembling K
+ *
+ * Each application gathers the three nodal values of every element, multiplies
+ * them by the element matrix and scatters the result. Elements are processed
+ * one ElementColoring color at a time: elements of one color share no node, so
+ * the loop over a color is threaded and vectorized with one element per SIMD
+ * lane and no conflicting writes.
+ */
+
+#ifndef MATRIXFREESTIFFNESS_H_
+#define MATRIXFREESTIFFNESS_H_
+
+#include <vector>
+#include "AlignedAllocator.h"
+#include "ElementColoring.h"
+#include "FEGrid.h"
+#include "StiffnessAssembler.h"
+
+/**
+ * @class MatrixFreeStiffness
+ * @brief Matrix-free K x for the rows of a StiffnessAssembler
+ *
+ * Vectors passed to multiply() are in the row numbering of the assembler, like
+ * those of CSRMatrix::multiply(). Internally the product runs on node-indexed
+ * vectors whose boundary entries are zero, so the element loop needs no masks:
+ * boundary columns multiply zero and boundary rows are never read back.
+ */
+class MatrixFreeStiffness
+{
+public:
+  /// Where the element matrices come from
+  enum Mode
+  {
+    CACHED,    ///< The 6 distinct entries of every symmetric 3x3 element matrix, stored per element
+    RECOMPUTE  ///< Element matrices rebuilt from the node coordinates on every application
+  };
+
+  MatrixFreeStiffness();
+
+  /**
+   * @brief Lay out the elements by color and, for CACHED, compute the element matrices
+   *
+   * @param a_grid Grid; must outlive the operator
+   * @param a_assembler Assembler whose rows the vectors use
+   * @param a_cMatrix Material matrix; must be symmetric
+   * @param a_coloring Coloring of a_grid
+   * @param a_mode CACHED or RECOMPUTE
+   * @param a_areaWeighted Scale the element matrices by the element area,
+   *        as StiffnessAssembler::setAreaWeighted()
+   * @throws std::invalid_argument If a_cMatrix is not symmetric
+   */
+  void setup(const FEGrid& a_grid, const StiffnessAssembler& a_assembler, const double a_cMatrix[DIM*DIM],
+             const ElementColoring& a_coloring, Mode a_mode, bool a_areaWeighted = false);
+
+  /**
+   * @brief y = K x
+   *
+   * @param a_x Input vector, one entry per row
+   * @param[out] a_y Output vector, one entry per row
+   */
+  void multiply(const double* a_x, double* a_y) const;
+
+  /// @return Number of rows
+  int getNumRows() const { return (int)m_rowNode.size(); }
+
+  /// @return Mode given to setup()
+  Mode getMode() const { return m_mode; }
+
+  /// @return Bytes of per-element data read by one multiply() (connectivity, matrices or coordinates)
+  size_t operatorBytes() const;
+
+private:
+  /// Element loop of one color, with the element matrices from m_k
+  void applyCached(int a_begin, int a_end) const;
+
+  /// Element loop of one color, rebuilding the element matrices from coordinates
+  void applyRecompute(int a_begin, int a_end) const;
+
+  const FEGrid* m_grid;                   ///< Grid (coordinates for RECOMPUTE)
+  Mode m_mode;                            ///< Mode
+  bool m_areaWeighted;                    ///< Element matrices scaled by the element area
+  double m_c[3];                          ///< C00, C01, C11
+  std::vector<int> m_colorOffsets;        ///< Range of every color in the arrays below
+  std::vector<int> m_v[VERTICES];         ///< Nodes of every element, in color order
+  AlignedVector<double> m_k[6];           ///< K00, K01, K02, K11, K12, K22 of every element (CACHED)
+  std::vector<int> m_rowNode;             ///< Node of every row
+  mutable AlignedVector<double> m_xNode;  ///< x by node, zero on boundary nodes
+  mutable AlignedVector<double> m_yNode;  ///< y by node
+};
+
+#endif // MATRIXFREESTIFFNESS_H_
@@ -0,0 +1,132 @@
+/**
+ * @file MatrixIO.h
+ * @brief Export and import of CSRMatrix as Matrix Market text and as binary CSR
+ *
+ * Matrix Market (.mtx) is the interchange format read by MATLAB, SciPy and
+ * most sparse tools; the symmetric variant stores only the lower triangle.
+ * The binary CSR file (.csrbin) is a fixed header followed by the row offsets,
+ * column indices and values, each 64-byte aligned, so a mapping of the file
+ * can be used as the matrix directly (MappedCSRMatrix), with no parsing.
+ */
+
+#ifndef MATRIXIO_H_
+#define MATRIXIO_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "CSRMatrix.h"
+#include "MeshIO.h"
+
+/**
+ * @struct CSRBinaryHeader
+ * @brief Header at the start of a .csrbin file
+ *
+ * Offsets are in bytes from the start of the file and multiples of 64.
+ */
+struct CSRBinaryHeader
+{
+  char     magic[8];        ///< "CSRBIN\0\0"
+  uint32_t version;         ///< Format version (CSRBIN_VERSION)
+  uint32_t reserved;        ///< Zero
+  int64_t  numRows;         ///< Number of rows and columns
+  int64_t  numNonzeros;     ///< Number of stored entries
+  uint64_t offsetsOffset;   ///< Byte offset of the row offsets (int32[numRows+1])
+  uint64_t columnsOffset;   ///< Byte offset of the columns (int32[numNonzeros])
+  uint64_t valuesOffset;    ///< Byte offset of the values (double[numNonzeros])
+};
+
+/** @brief Current .csrbin format version */
+#define CSRBIN_VERSION 1
+
+/**
+ * @brief Write a matrix as a Matrix Market coordinate file
+ *
+ * Indices are 1-based and values are written with the shortest representation
+ * that reads back to the same double.
+ *
+ * @param a_fileName Path of the .mtx file
+ * @param a_K Matrix
+ * @param a_symmetric Write "symmetric" with the lower triangle only; a_K must then be symmetric
+ * @return true if the file was written completely
+ */
+bool writeMatrixMarket(const std::string& a_fileName, const CSRMatrix& a_K, bool a_symmetric = true);
+
+/**
+ * @brief Read a real coordinate Matrix Market file, general or symmetric
+ *
+ * @param a_fileName Path of the .mtx file
+ * @param[out] a_K Matrix; entries are sorted within rows and duplicates summed
+ * @throws std::runtime_error If the file cannot be read, is not a square real
+ *         coordinate matrix, or is malformed
+ */
+void readMatrixMarket(const std::string& a_fileName, CSRMatrix& a_K);
+
+/**
+ * @brief Write a matrix as a binary CSR file
+ *
+ * @param a_fileName Path of the .csrbin file
+ * @param a_K Matrix
+ * @return true if the file was written completely
+ */
+bool writeCSRBinary(const std::string& a_fileName, const CSRMatrix& a_K);
+
+/**
+ * @class MappedCSRMatrix
+ * @brief Read-only CSR matrix backed by a mapping of a .csrbin file
+ *
+ * The arrays point into the mapping, so opening costs one mmap regardless of
+ * the size of the matrix, and pages are read on first use.
+ */
+class MappedCSRMatrix
+{
+public:
+  /**
+   * @brief Map a .csrbin file
+   *
+   * @param a_fileName Path of the file
+   * @throws std::runtime_error If the file is missing, of another version, or
+   *         truncated, or its arrays are misaligned or out of range
+   */
+  explicit MappedCSRMatrix(const std::string& a_fileName);
+
+  /// @return Number of rows (equal to the number of columns)
+  int getNumRows() const { return m_numRows; }
+
+  /// @return Number of stored entries
+  long getNumNonzeros() const { return m_numNonzeros; }
+
+  /// @return getNumRows()+1 row offsets
+  const int* rowOffsets() const { return m_rowOffsets; }
+
+  /// @return Column index of every entry
+  const int* columns() const { return m_columns; }
+
+  /// @return Value of every entry
+  const double* values() const { return m_values; }
+
+  /**
+   * @brief Sparse matrix-vector product y = A x, straight from the mapping
+   *
+   * @param a_x Input vector of getNumRows() entries
+   * @param[out] a_y Output vector of getNumRows() entries
+   */
+  void multiply(const double* a_x, double* a_y) const;
+
+  /**
+   * @brief Copy into a CSRMatrix, for the solvers that own their matrix
+   *
+   * @param[out] a_K Matrix with the same pattern and values
+   */
+  void copyTo(CSRMatrix& a_K) const;
+
+private:
+  std::unique_ptr<MappedFile> m_file; ///< Mapping of the whole file
+  int m_numRows;                      ///< Number of rows
+  long m_numNonzeros;                 ///< Number of entries
+  const int* m_rowOffsets;            ///< Row offsets in the mapping
+  const int* m_columns;               ///< Columns in the mapping
+  const double* m_values;             ///< Values in the mapping
+};
+
+#endif // MATRIXIO_H_
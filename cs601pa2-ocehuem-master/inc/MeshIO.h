@@ -0,0 +1,213 @@
+/**
+ * @file MeshIO.h
+ * @brief Fast readers and writers for triangle mesh files
+ *
+ * This file declares the mesh input/output layer used by FEGrid. Text meshes
+ * (.node/.elem) are memory-mapped and parsed with std::from_chars in parallel
+ * over line-aligned chunks. A parsed mesh can be saved as a binary .femesh
+ * cache whose aligned arrays are read back by mapping the file, with no parsing.
+ */
+
+#ifndef MESHIO_H_
+#define MESHIO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The mapping is released when the object is destroyed.
+ */
+class MappedFile
+{
+public:
+  /**
+   * @brief Map a file into memory
+   *
+   * @param a_fileName Path of the file to map
+   * @throws std::runtime_error If the file cannot be opened or mapped
+   */
+  explicit MappedFile(const std::string& a_fileName);
+
+  /// Unmaps the file
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// @return Pointer to the first byte of the file
+  const char* data() const { return m_data; }
+
+  /// @return Size of the file in bytes
+  size_t size() const { return m_size; }
+
+private:
+  const char* m_data;  ///< Start of the mapping (nullptr for an empty file)
+  size_t m_size;       ///< Length of the mapping in bytes
+};
+
+/**
+ * @struct MeshView
+ * @brief Read-only pointers to the arrays of a mesh
+ *
+ * Points into a MeshData or into a mapped .femesh file (mapMeshCache()), with
+ * the same layout as MeshData. The arrays must outlive the view.
+ */
+struct MeshView
+{
+  int numNodes;                   ///< Number of nodes
+  int numElts;                    ///< Number of elements
+  const double* x;                ///< x coordinate of each node
+  const double* y;                ///< y coordinate of each node
+  const unsigned char* boundary;  ///< Boundary flag of each node, nullptr if the mesh has none
+  const int* vertices;            ///< VERTICES node numbers per element
+};
+
+/**
+ * @struct MeshData
+ * @brief Plain arrays describing a triangle mesh
+ *
+ * Node and vertex numbers are zero based. Coordinates are stored as separate
+ * x and y arrays, and connectivity as VERTICES consecutive node numbers per element.
+ */
+struct MeshData
+{
+  std::vector<double> x;                ///< x coordinate of each node
+  std::vector<double> y;                ///< y coordinate of each node
+  std::vector<unsigned char> boundary;  ///< 1 if the node lies on the boundary; empty if not known
+  std::vector<int> vertices;            ///< VERTICES node numbers per element
+
+  /// @return Number of nodes
+  int numNodes() const { return (int)x.size(); }
+
+  /// @return Number of elements
+  int numElts() const { return (int)(vertices.size() / 3); }
+
+  /// @return View of the arrays
+  MeshView view() const
+  {
+    MeshView v = {numNodes(), numElts(), x.data(), y.data(),
+                  (int)boundary.size() == numNodes() ? boundary.data() : nullptr, vertices.data()};
+    return v;
+  }
+};
+
+/**
+ * @struct FEMeshHeader
+ * @brief Fixed 64-byte header at the start of a .femesh file
+ *
+ * Every array starts at a 64-byte aligned offset from the start of the file,
+ * so the arrays of a mapped cache can be read in place (mapMeshCache()).
+ */
+struct FEMeshHeader
+{
+  char     magic[8];        ///< "FEMESH\0\0"
+  uint32_t version;         ///< Format version (FEMESH_VERSION)
+  uint32_t flags;           ///< FEMESH_HAS_BOUNDARY if the boundary flags are valid
+  int64_t  numNodes;        ///< Number of nodes
+  int64_t  numElts;         ///< Number of elements
+  uint64_t xOffset;         ///< Byte offset of the x coordinates (double[numNodes])
+  uint64_t yOffset;         ///< Byte offset of the y coordinates (double[numNodes])
+  uint64_t boundaryOffset;  ///< Byte offset of the boundary flags (uint8[numNodes], zero if not valid)
+  uint64_t verticesOffset;  ///< Byte offset of the connectivity (int32[3*numElts])
+};
+
+/**
+ * @brief Current .femesh format version
+ *
+ * Version 2 marks whether the boundary flags are valid; FEGrid checks valid
+ * flags against the mesh topology. Version 1 caches are rebuilt from the text.
+ */
+#define FEMESH_VERSION 2
+
+/** @brief FEMeshHeader::flags bit: the boundary flags are valid */
+#define FEMESH_HAS_BOUNDARY 1u
+
+/**
+ * @brief Parse a .node/.elem pair
+ *
+ * Both files are memory-mapped. After the leading count, the body of each file
+ * is split into one line-aligned chunk per thread; every line carries its own
+ * 1-based id, so chunks are parsed independently with std::from_chars.
+ * Every id from 1 to the count must appear exactly once.
+ * The text format has no boundary flags, so a_mesh.boundary is left empty.
+ *
+ * @param a_nodeFileName Path of the .node file
+ * @param a_elementFileName Path of the .elem file
+ * @param[out] a_mesh Parsed mesh
+ * @throws std::runtime_error If a file cannot be read or is malformed, or if
+ *         an id is missing or repeated
+ */
+void readTextMesh(const std::string& a_nodeFileName,
+                  const std::string& a_elementFileName,
+                  MeshData& a_mesh);
+
+/**
+ * @brief Write a mesh as a .node/.elem pair
+ *
+ * Lines are formatted in batches, one slice of each batch per thread, with
+ * std::to_chars (shortest form that reads back to the same double), and the
+ * slices are written in order. Boundary flags are not part of the text format.
+ *
+ * @param a_nodeFileName Path of the .node file
+ * @param a_elementFileName Path of the .elem file
+ * @param a_mesh Mesh to write
+ * @return true if both files were written completely
+ */
+bool writeTextMesh(const std::string& a_nodeFileName,
+                   const std::string& a_elementFileName,
+                   const MeshData& a_mesh);
+
+/**
+ * @brief Write a mesh as a binary .femesh cache
+ *
+ * The boundary flags are stored, and marked valid, if a_mesh has one per node.
+ *
+ * @param a_fileName Path of the cache file
+ * @param a_mesh Mesh to store
+ * @return true if the file was written completely
+ */
+bool writeMeshCache(const std::string& a_fileName, const MeshData& a_mesh);
+
+/**
+ * @brief Map a binary .femesh cache and check it for use in place
+ *
+ * The header is validated against the file: every array must be 64-byte
+ * aligned and lie inside the file, and every node number must be in range.
+ * A corrupt or truncated cache is rejected, never read past.
+ *
+ * @param a_fileName Path of the cache file
+ * @param[out] a_file Mapping of the file; must outlive a_view
+ * @param[out] a_view Arrays inside the mapping
+ * @return false if the file is missing, of another version, or inconsistent
+ */
+bool mapMeshCache(const std::string& a_fileName, std::unique_ptr<MappedFile>& a_file, MeshView& a_view);
+
+/**
+ * @brief Read a binary .femesh cache into MeshData
+ *
+ * mapMeshCache() followed by a copy of the arrays. FEGrid reads the view of
+ * mapMeshCache() directly, which saves this copy.
+ *
+ * @param a_fileName Path of the cache file
+ * @param[out] a_mesh Mesh read from the cache
+ * @return false if the file is missing, of another version, or inconsistent
+ */
+bool readMeshCache(const std::string& a_fileName, MeshData& a_mesh);
+
+/**
+ * @brief Check whether a cache file exists and is newer than its sources
+ *
+ * @param a_cacheFileName Path of the .femesh file
+ * @param a_sources Paths of the files the cache was built from
+ * @return true if the cache can be used instead of the sources
+ */
+bool meshCacheIsFresh(const std::string& a_cacheFileName,
+                      const std::vector<std::string>& a_sources);
+
+#endif // MESHIO_H_
@@ -0,0 +1,132 @@
+/**
+ * @file MeshPartition.h
+ * @brief Recursive coordinate bisection of a FEGrid and partitioned K x with halo exchange
+ *
+ * The partitioned operator is laid out as a distributed-memory code would lay
+ * it out: every part owns a set of rows of the global stiffness matrix, keeps
+ * only its own rows and vectors in local numbering, and gets the values of
+ * other parts' rows it needs (its ghosts, or halo) through explicit send and
+ * receive buffers. Parts run on OpenMP threads and the buffers are in shared
+ * memory, but no part reads another part's vectors directly.
+ */
+
+#ifndef MESHPARTITION_H_
+#define MESHPARTITION_H_
+
+#include <vector>
+#include "AlignedAllocator.h"
+#include "FEGrid.h"
+#include "StiffnessAssembler.h"
+
+/**
+ * @class MeshPartition
+ * @brief Splits the rows (interior nodes) and elements of a grid into parts
+ *
+ * Rows are split by recursive coordinate bisection of the node positions: a
+ * set of rows is cut at the median (weighted by the number of parts on each
+ * side) of its longer extent, and each half is cut again. An element belongs
+ * to the part owning most of its interior vertices. A part assembles the full
+ * rows it owns, so it also computes the elements of other parts that touch
+ * its rows (owner computes; reported as redundant elements).
+ */
+class MeshPartition
+{
+public:
+  MeshPartition();
+
+  /**
+   * @brief Partition a grid and build the local matrices' patterns and halo lists
+   *
+   * @param a_grid Grid
+   * @param a_assembler Assembler of a_grid; its row numbering is the global numbering
+   * @param a_numParts Number of parts
+   */
+  void build(const FEGrid& a_grid, const StiffnessAssembler& a_assembler, int a_numParts);
+
+  /**
+   * @brief Every part computes the element matrices of its elements and
+   *        assembles its own rows, in parallel over parts
+   *
+   * @param a_assembler Assembler given to build()
+   */
+  void assemble(const StiffnessAssembler& a_assembler);
+
+  /**
+   * @brief Copy the owned entries of a global vector into every part
+   *
+   * @param a_x Global vector, one entry per row
+   */
+  void distribute(const double* a_x);
+
+  /// Fill the ghost entries of every part's x from the owners' send buffers
+  void exchangeHalo();
+
+  /// y = K x on every part: halo exchange, then the local product of the owned rows
+  void multiply();
+
+  /**
+   * @brief Copy every part's owned entries of y into a global vector
+   *
+   * @param[out] a_y Global vector, one entry per row
+   */
+  void collect(double* a_y) const;
+
+  /// @return Number of parts
+  int getNumParts() const { return (int)m_parts.size(); }
+
+  /// @return Part owning every global row
+  const std::vector<int>& rowPart() const { return m_rowPart; }
+
+  /// @return Part of every element, -1 for elements with no interior vertex
+  const std::vector<int>& elementPart() const { return m_elementPart; }
+
+  /// @return Rows owned by part a_part
+  int getNumOwned(int a_part) const { return m_parts[a_part].numOwned; }
+
+  /// @return Ghost rows of part a_part
+  int getNumGhosts(int a_part) const { return (int)m_parts[a_part].rows.size() - m_parts[a_part].numOwned; }
+
+  /// @return Elements assembled by part a_part, including redundant ones
+  int getNumElements(int a_part) const { return (int)m_parts[a_part].elements.size(); }
+
+  /// @return Stored entries of the local matrix of part a_part
+  int getNumNonzeros(int a_part) const { return (int)m_parts[a_part].columns.size(); }
+
+  /// @return Number of neighbouring parts of part a_part
+  int getNumNeighbours(int a_part) const { return (int)m_parts[a_part].neighbours.size(); }
+
+  /// @return Edges i-j of the matrix graph (i < j, K_ij stored) whose rows are in different parts
+  long edgeCut() const { return m_edgeCut; }
+
+private:
+  /// Rows, local operator and halo lists of one part
+  struct Part
+  {
+    std::vector<int> rows;           ///< Global row of every local index: owned rows first, then ghosts
+    int numOwned;                    ///< Number of owned rows
+    std::vector<int> elements;       ///< Elements touching an owned row
+    std::vector<int> slots;          ///< Position in values of every element entry, -1 if not an owned row
+    std::vector<int> offsets;        ///< CSR row offsets of the owned rows
+    std::vector<int> columns;        ///< Local column indices
+    AlignedVector<double> values;    ///< Local matrix
+    std::vector<int> neighbours;     ///< Parts exchanging with this one
+    std::vector<int> sendOffsets;    ///< Per neighbour, range in sendIndices/sendBuffer
+    std::vector<int> sendIndices;    ///< Owned local indices to send
+    AlignedVector<double> sendBuffer; ///< Packed values for the neighbours
+    std::vector<int> recvOffsets;    ///< Per neighbour, range of ghosts received (after numOwned)
+    std::vector<int> recvSource;     ///< Per neighbour, start of this part's data in its send buffer
+    AlignedVector<double> x;         ///< Local x, owned and ghost entries
+    AlignedVector<double> y;         ///< Local y, owned entries
+  };
+
+  /// Split a_rows[a_begin, a_end) into a_numParts parts numbered from a_firstPart
+  void bisect(std::vector<int>& a_rows, int a_begin, int a_end, int a_firstPart, int a_numParts,
+              const double* a_x, const double* a_y);
+
+  std::vector<Part> m_parts;       ///< Parts
+  std::vector<int> m_rowPart;      ///< Owner of every global row
+  std::vector<int> m_elementPart;  ///< Home part of every element
+  long m_edgeCut;                  ///< Cut matrix graph edges
+};
+
+#endif // MESHPARTITION_H_
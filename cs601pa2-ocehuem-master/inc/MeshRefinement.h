@@ -0,0 +1,41 @@
+/**
+ * @file MeshRefinement.h
+ * @brief Uniform refinement of triangle meshes
+ *
+ * Every triangle is split into four by the midpoints of its edges. A midpoint
+ * is shared by the (at most two) triangles of its edge; edges are deduplicated
+ * through a hash table keyed by their two end nodes, filled by all threads at
+ * once. Repeated refinement turns the small sample meshes into benchmark
+ * meshes of 10^5 to 10^7 elements.
+ */
+
+#ifndef MESHREFINEMENT_H_
+#define MESHREFINEMENT_H_
+
+#include <vector>
+#include "MeshIO.h"
+
+/**
+ * @brief Split every triangle of a mesh into four
+ *
+ * Element e with vertices (v0, v1, v2) and edge midpoints m01, m12, m20 becomes
+ * elements 4e..4e+3: (v0, m01, m20), (m01, v1, m12), (m20, m12, v2) and
+ * (m01, m12, m20), all with the orientation of e. The nodes of a_coarse keep
+ * their numbers; midpoints follow, numbered in element order of the first
+ * element containing each edge, so the result does not depend on the number
+ * of threads.
+ *
+ * Boundary flags are propagated: a node of the refined mesh is a boundary
+ * node when it lies on an edge used by only one element, which for the
+ * original nodes agrees with the classification done by FEGrid.
+ *
+ * @param a_coarse Mesh to refine
+ * @param[out] a_fine Refined mesh, 4x the elements of a_coarse
+ * @param[out] a_midpointEnds If given, receives the two end nodes (in a_coarse)
+ *        of the edge of every midpoint: entries 2m and 2m+1 for node
+ *        a_coarse.numNodes() + m of a_fine. Used to interpolate between the meshes.
+ */
+void refineMesh(const MeshData& a_coarse, MeshData& a_fine,
+                std::vector<int>* a_midpointEnds = nullptr);
+
+#endif // MESHREFINEMENT_H_
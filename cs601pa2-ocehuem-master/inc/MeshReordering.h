@@ -0,0 +1,44 @@
+/**
+ * @file MeshReordering.h
+ * @brief Space-filling-curve reordering of the elements and nodes of a mesh
+ *
+ * Elements sorted along a Morton (Z-order) or Hilbert curve through their
+ * centroids are neighbours in memory when they are neighbours in the plane,
+ * and numbering the nodes in the order those elements first touch them keeps
+ * the nodes of consecutive elements close together as well. Element loops
+ * (geometry, assembly, matrix-free products) then reuse the cache lines of
+ * the node arrays instead of jumping through them.
+ */
+
+#ifndef MESHREORDERING_H_
+#define MESHREORDERING_H_
+
+#include <vector>
+#include "MeshIO.h"
+
+/// Space-filling curves for reorderMesh()
+enum SpaceFillingCurve
+{
+  MORTON,   ///< Bit interleaving (Z-order); cheap, with jumps between quadrants
+  HILBERT   ///< Hilbert curve; consecutive cells are always adjacent
+};
+
+/**
+ * @brief Renumber the elements along a space-filling curve and the nodes by first touch
+ *
+ * Centroids are scaled to a 2^16 x 2^16 grid over the bounding box of the nodes.
+ * Elements with equal keys keep their relative order, nodes not used by any
+ * element go last in their old order, and vertex order within each element is
+ * kept, so orientation and boundary flags carry over unchanged.
+ *
+ * @param a_in Mesh to reorder
+ * @param[out] a_out Reordered mesh (must not be a_in)
+ * @param a_curve MORTON or HILBERT
+ * @param[out] a_newToOldElement If given, old number of every new element
+ * @param[out] a_newToOldNode If given, old number of every new node
+ */
+void reorderMesh(const MeshData& a_in, MeshData& a_out, SpaceFillingCurve a_curve,
+                 std::vector<int>* a_newToOldElement = nullptr,
+                 std::vector<int>* a_newToOldNode = nullptr);
+
+#endif // MESHREORDERING_H_
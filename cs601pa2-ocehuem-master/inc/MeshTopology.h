@@ -0,0 +1,113 @@
+/**
+ * @file MeshTopology.h
+ * @brief Adjacency index of a triangle mesh
+ *
+ * This file defines the MeshTopology class which derives, in time linear in the
+ * mesh size, the node-to-element and element-to-element adjacency of a triangle
+ * mesh in compressed sparse row (CSR) form, together with its boundary edges.
+ * It is the basis for boundary classification, element coloring, partitioning
+ * and sparse matrix patterns.
+ */
+
+#ifndef MESHTOPOLOGY_H_
+#define MESHTOPOLOGY_H_
+
+#include <vector>
+#include "Element.h"
+
+/**
+ * @class MeshTopology
+ * @brief CSR adjacency lists and boundary edges of a triangle mesh
+ *
+ * Local edge k of an element joins its local vertices k and (k+1)%VERTICES.
+ * An edge owned by exactly one element is a boundary edge, and a node is a
+ * boundary node if it lies on a boundary edge.
+ */
+class MeshTopology
+{
+public:
+  /**
+   * @brief Default constructor
+   *
+   * Creates an empty topology.
+   */
+  MeshTopology();
+
+  /**
+   * @brief Build all adjacency information for a mesh
+   *
+   * @param a_numNodes Number of nodes in the mesh
+   * @param a_elements Elements of the mesh (vertex numbers in [0, a_numNodes))
+   */
+  void build(int a_numNodes, const std::vector<Element>& a_elements);
+
+  /// @return Number of nodes the topology was built for
+  int getNumNodes() const { return (int)m_nodeEltOffsets.size() - 1; }
+
+  /// @return Number of elements the topology was built for
+  int getNumElts() const { return (int)m_edgeNeighbors.size() / VERTICES; }
+
+  /**
+   * @brief CSR offsets of the node-to-element lists
+   *
+   * Elements touching node i are nodeElts()[nodeEltOffsets()[i] .. nodeEltOffsets()[i+1]).
+   */
+  const std::vector<int>& nodeEltOffsets() const { return m_nodeEltOffsets; }
+
+  /// @return Concatenated node-to-element lists, sorted by element number per node
+  const std::vector<int>& nodeElts() const { return m_nodeElts; }
+
+  /**
+   * @brief CSR offsets of the element-to-element lists
+   *
+   * Elements sharing an edge with element e are
+   * eltElts()[eltEltOffsets()[e] .. eltEltOffsets()[e+1]).
+   */
+  const std::vector<int>& eltEltOffsets() const { return m_eltEltOffsets; }
+
+  /// @return Concatenated element-to-element (edge neighbor) lists
+  const std::vector<int>& eltElts() const { return m_eltElts; }
+
+  /**
+   * @brief Neighbor of an element across one of its edges
+   *
+   * @param a_eltNumber Element number
+   * @param a_localEdge Local edge number (0, 1 or 2)
+   * @return int Neighboring element, or -1 if the edge is on the boundary
+   */
+  int edgeNeighbor(int a_eltNumber, int a_localEdge) const
+  { return m_edgeNeighbors[a_eltNumber*VERTICES + a_localEdge]; }
+
+  /// @return Number of boundary edges
+  int getNumBoundaryEdges() const { return (int)m_boundaryEdgeElts.size(); }
+
+  /**
+   * @brief End points of the boundary edges
+   *
+   * Boundary edge j joins nodes boundaryEdges()[2*j] and boundaryEdges()[2*j+1].
+   */
+  const std::vector<int>& boundaryEdges() const { return m_boundaryEdges; }
+
+  /// @return Element owning each boundary edge
+  const std::vector<int>& boundaryEdgeElts() const { return m_boundaryEdgeElts; }
+
+  /**
+   * @brief Check whether a node lies on the mesh boundary
+   *
+   * @param a_node Node number
+   * @return bool true if the node is an end point of a boundary edge
+   */
+  bool isBoundaryNode(int a_node) const { return m_isBoundaryNode[a_node] != 0; }
+
+private:
+  std::vector<int> m_nodeEltOffsets;           ///< CSR offsets, node -> elements
+  std::vector<int> m_nodeElts;                 ///< CSR entries, node -> elements
+  std::vector<int> m_edgeNeighbors;            ///< VERTICES edge neighbors per element (-1 on boundary)
+  std::vector<int> m_eltEltOffsets;            ///< CSR offsets, element -> elements
+  std::vector<int> m_eltElts;                  ///< CSR entries, element -> elements
+  std::vector<int> m_boundaryEdges;            ///< Two end nodes per boundary edge
+  std::vector<int> m_boundaryEdgeElts;         ///< Owning element per boundary edge
+  std::vector<unsigned char> m_isBoundaryNode; ///< 1 for nodes on a boundary edge
+};
+
+#endif // MESHTOPOLOGY_H_
@@ -0,0 +1,129 @@
+/**
+ * @file MixedPrecisionSolver.h
+ * @brief Mixed-precision iterative refinement for the stiffness system
+ *
+ * The expensive inner solve, a band Cholesky factor or a preconditioned CG,
+ * runs in single precision, which halves its memory traffic. The residual
+ * r = b - K x and the correction x += d are kept in double, so the solution
+ * still reaches double precision accuracy:
+ *
+ *     repeat: r = b - K x (double); solve K d = r (single); x += d
+ *
+ * Each refinement step reduces the error by roughly the accuracy of the inner
+ * solve (cond(K) * 6e-8 for the single-precision factor, the inner tolerance
+ * for CG), so a few steps go from single to double precision.
+ */
+
+#ifndef MIXEDPRECISIONSOLVER_H_
+#define MIXEDPRECISIONSOLVER_H_
+
+#include <cstddef>
+#include "AlignedAllocator.h"
+#include "BandCholesky.h"
+#include "CSRMatrix.h"
+
+/**
+ * @class MixedPrecisionSolver
+ * @brief Solves K u = f in double with a single-precision inner solver
+ *
+ * setup() rounds K once to single precision (the band factor, or the values of
+ * a float copy of K sharing its pattern); solve() then does refinement steps
+ * until the double-precision residual meets the tolerance.
+ */
+class MixedPrecisionSolver
+{
+public:
+  /// Single-precision inner solvers
+  enum InnerSolver
+  {
+    BAND_CHOLESKY,      ///< Band Cholesky factor in float (BandCholeskyFloat)
+    CONJUGATE_GRADIENT  ///< Jacobi-preconditioned CG on a float copy of K
+  };
+
+  /**
+   * @brief Default constructor
+   *
+   * setup() must be called before solve().
+   */
+  MixedPrecisionSolver();
+
+  /**
+   * @brief Set the matrix and build the single-precision inner solver
+   *
+   * @param a_K Symmetric positive definite matrix; must outlive the solver.
+   *        For BAND_CHOLESKY, renumber it first (NodeOrdering::buildRCM)
+   * @param a_inner Inner solver
+   * @throws std::runtime_error If the single-precision factor breaks down
+   *         or a diagonal entry is not positive
+   */
+  void setup(const CSRMatrix& a_K, InnerSolver a_inner);
+
+  /**
+   * @brief Relative residual at which the inner CG stops, default 1e-3
+   *
+   * Near the single-precision limit further inner iterations stop paying off;
+   * the outer loop makes up the rest.
+   *
+   * @param a_tolerance Inner relative residual
+   * @param a_maxIterations Inner iteration limit per refinement step
+   */
+  void setInnerTolerance(double a_tolerance, int a_maxIterations);
+
+  /**
+   * @brief Solve K x = b by iterative refinement
+   *
+   * Stops when ||b - K x|| <= a_tolerance ||b|| in double precision, after
+   * a_maxRefinements steps, or when a step fails to halve the residual (K too
+   * ill-conditioned for the single-precision inner solve). A final step that
+   * increased the residual is undone, so x is the best iterate and
+   * getRelativeResidual() its residual.
+   *
+   * @param a_b Right-hand side (getNumRows() entries)
+   * @param[in,out] a_x Initial guess on input, solution on output
+   * @param a_tolerance Relative residual tolerance
+   * @param a_maxRefinements Limit of refinement steps
+   * @return int Number of refinement steps (inner solves) done
+   */
+  int solve(const double* a_b, double* a_x, double a_tolerance, int a_maxRefinements);
+
+  /// @return Relative residual ||b - K x|| / ||b|| reached by the last solve()
+  double getRelativeResidual() const { return m_relativeResidual; }
+
+  /// @return Whether the last solve() reached its tolerance
+  bool converged() const { return m_converged; }
+
+  /// @return Inner CG iterations summed over the refinement steps of the last solve()
+  int getInnerIterations() const { return m_innerIterations; }
+
+  /// @return Number of rows of the matrix given to setup()
+  int getNumRows() const { return m_K ? m_K->getNumRows() : 0; }
+
+  /// @return Bytes of single-precision data (band factor, or float values and work vectors)
+  size_t memoryBytes() const;
+
+private:
+  /// Jacobi-preconditioned CG in float on K d = m_r; returns iterations
+  int innerCG(float* a_d);
+
+  /// y = K x with the float values
+  void multiplyFloat(const float* a_x, float* a_y) const;
+
+  const CSRMatrix* m_K;             ///< Matrix being solved
+  InnerSolver m_inner;              ///< Inner solver built by setup()
+  BandCholeskyFloat m_band;         ///< Single-precision factor (BAND_CHOLESKY)
+  AlignedVector<float> m_values;    ///< K's values in float, K's pattern (CONJUGATE_GRADIENT)
+  AlignedVector<float> m_invDiag;   ///< 1/K_ii (CONJUGATE_GRADIENT)
+  double m_innerTolerance;          ///< Inner CG relative residual
+  int m_innerMaxIterations;         ///< Inner CG iteration limit
+  AlignedVector<double> m_residual; ///< b - K x
+  AlignedVector<float> m_r;         ///< Scaled residual, then inner CG residual
+  AlignedVector<float> m_d;         ///< Correction
+  AlignedVector<float> m_z;         ///< Inner CG preconditioned residual
+  AlignedVector<float> m_p;         ///< Inner CG search direction
+  AlignedVector<float> m_q;         ///< Inner CG K p
+  double m_relativeResidual;        ///< Result of the last solve
+  bool m_converged;                 ///< Result of the last solve
+  int m_innerIterations;            ///< Inner CG iterations of the last solve
+};
+
+#endif // MIXEDPRECISIONSOLVER_H_
@@ -0,0 +1,142 @@
+/**
+ * @file Multigrid.h
+ * @brief Geometric multigrid for the stiffness system on a hierarchy of refined meshes
+ *
+ * The hierarchy is built from a coarse mesh by repeated uniform refinement
+ * (refineMesh), so the meshes are nested: a node of a coarse mesh is also a
+ * node of the next finer one, and every other fine node is the midpoint of a
+ * coarse edge. Prolongation is linear interpolation, restriction its transpose,
+ * and the coarse operators are the Galerkin products P^T A P, so they need no
+ * assembly of their own.
+ */
+
+#ifndef MULTIGRID_H_
+#define MULTIGRID_H_
+
+#include <memory>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "BandCholesky.h"
+#include "CSRMatrix.h"
+#include "FEGrid.h"
+#include "MeshIO.h"
+#include "NodeOrdering.h"
+
+/**
+ * @class Multigrid
+ * @brief V-cycle solver and preconditioner
+ *
+ * Levels are numbered from 0 (the coarse mesh, solved directly with
+ * BandCholesky after RCM renumbering) to getNumLevels()-1 (the finest mesh, whose stiffness matrix
+ * is matrix()). Smoothing is Gauss-Seidel: forward sweeps before the coarse
+ * correction and backward sweeps after it, so the V-cycle is symmetric and can
+ * precondition CG. Rows are the interior nodes of each mesh in node order.
+ */
+class Multigrid
+{
+public:
+  /**
+   * @brief Default constructor
+   *
+   * setup() must be called before solving.
+   */
+  Multigrid();
+
+  ~Multigrid();
+
+  /**
+   * @brief Build the hierarchy and the operators
+   *
+   * @param a_coarseMesh Coarsest mesh (level 0)
+   * @param a_numRefinements Number of refinements; getNumLevels() is one more
+   * @param a_cMatrix Material matrix C of the stiffness matrix
+   */
+  void setup(const MeshData& a_coarseMesh, int a_numRefinements, const double a_cMatrix[DIM*DIM]);
+
+  /**
+   * @brief Number of Gauss-Seidel sweeps before and after the coarse correction
+   *
+   * @param a_preSweeps Forward sweeps (default 2)
+   * @param a_postSweeps Backward sweeps (default 2)
+   */
+  void setSmoothing(int a_preSweeps, int a_postSweeps);
+
+  /// @return Number of levels
+  int getNumLevels() const { return (int)m_levels.size(); }
+
+  /// @return Finest grid
+  const FEGrid& grid() const { return *m_grid; }
+
+  /// @return Stiffness matrix of the finest grid
+  const CSRMatrix& matrix() const { return m_levels.back().A; }
+
+  /**
+   * @brief Stiffness matrix of one level
+   *
+   * @param a_level Level, 0 = coarsest
+   */
+  const CSRMatrix& matrix(int a_level) const { return m_levels[a_level].A; }
+
+  /**
+   * @brief Solve A x = b on the finest level by V-cycles
+   *
+   * @param a_b Right-hand side
+   * @param[in,out] a_x Initial guess, then solution
+   * @param a_tolerance Relative residual tolerance
+   * @param a_maxCycles Cycle limit
+   * @return int Number of V-cycles done
+   */
+  int solve(const double* a_b, double* a_x, double a_tolerance, int a_maxCycles);
+
+  /// @return Relative residual reached by the last solve()
+  double getRelativeResidual() const { return m_relativeResidual; }
+
+  /**
+   * @brief One V-cycle from a zero guess, z ~= A^{-1} r
+   *
+   * This is the preconditioner used by ConjugateGradient::setup(K, Multigrid&).
+   *
+   * @param a_r Residual on the finest level
+   * @param[out] a_z Approximate solution of A z = r
+   */
+  void precondition(const double* a_r, double* a_z) const;
+
+private:
+  /// Operators and work vectors of one level
+  struct Level
+  {
+    CSRMatrix A;                     ///< Operator
+    std::vector<int> diag;           ///< Position of the diagonal entry of every row in A
+    std::vector<int> prolongOffsets; ///< CSR of P (rows of this level <- rows of the level below)
+    std::vector<int> prolongColumns; ///< Columns of P
+    std::vector<double> prolongValues; ///< Values of P (1 or 1/2)
+    std::vector<int> restrictOffsets;  ///< CSR of P^T
+    std::vector<int> restrictColumns;  ///< Columns of P^T
+    std::vector<double> restrictValues; ///< Values of P^T
+    mutable AlignedVector<double> x;   ///< Correction
+    mutable AlignedVector<double> b;   ///< Right-hand side
+    mutable AlignedVector<double> r;   ///< Residual
+  };
+
+  /// V-cycle on level a_level for the vectors stored in that level
+  void vcycle(int a_level) const;
+
+  /// One Gauss-Seidel sweep on level a_level, forward or backward
+  void smooth(int a_level, bool a_forward) const;
+
+  /// Galerkin coarse operator P^T A P of level a_level + 1 into level a_level
+  void galerkin(int a_level);
+
+  /// Renumber the level 0 operator by RCM and factor it
+  void factorCoarse();
+
+  std::vector<Level> m_levels;     ///< Level 0 is the coarsest
+  std::unique_ptr<FEGrid> m_grid;  ///< Finest grid
+  NodeOrdering m_coarseOrder;      ///< RCM order of the level 0 rows
+  BandCholesky m_coarseSolver;     ///< Factor of the level 0 operator in m_coarseOrder
+  int m_preSweeps;                 ///< Forward sweeps per level
+  int m_postSweeps;                ///< Backward sweeps per level
+  double m_relativeResidual;       ///< Result of the last solve
+};
+
+#endif // MULTIGRID_H_
@@ -0,0 +1,57 @@
+/**
+ * @file NodeOrdering.h
+ * @brief Bandwidth-reducing renumbering of the rows of the global stiffness matrix
+ *
+ * Rows of the global matrix are interior nodes. Reverse Cuthill-McKee numbers
+ * them breadth first from a peripheral node, so neighbours get close numbers:
+ * the bandwidth and profile shrink and SpMV reads x from a narrow window.
+ */
+
+#ifndef NODEORDERING_H_
+#define NODEORDERING_H_
+
+#include <vector>
+#include "CSRMatrix.h"
+
+/**
+ * @class NodeOrdering
+ * @brief Permutation of the rows of a structurally symmetric matrix
+ *
+ * newToOld()[r] is the old row placed at new row r; oldToNew() is its inverse.
+ */
+class NodeOrdering
+{
+public:
+  /**
+   * @brief Reverse Cuthill-McKee ordering of the graph of a CSR pattern
+   *
+   * Each connected component starts from a pseudo-peripheral row (repeated
+   * breadth-first searches from a minimum-degree row); neighbours are queued in
+   * increasing degree and the final order is reversed.
+   *
+   * @param a_pattern Matrix with a symmetric sparsity pattern; values are ignored
+   */
+  void buildRCM(const CSRMatrix& a_pattern);
+
+  /**
+   * @brief Use a given permutation
+   *
+   * @param a_newToOld Old row of every new row
+   */
+  void set(const std::vector<int>& a_newToOld);
+
+  /// @return Number of rows permuted
+  int getNumRows() const { return (int)m_newToOld.size(); }
+
+  /// @return Old row of every new row
+  const std::vector<int>& newToOld() const { return m_newToOld; }
+
+  /// @return New row of every old row
+  const std::vector<int>& oldToNew() const { return m_oldToNew; }
+
+private:
+  std::vector<int> m_newToOld;  ///< Old row of every new row
+  std::vector<int> m_oldToNew;  ///< New row of every old row
+};
+
+#endif // NODEORDERING_H_
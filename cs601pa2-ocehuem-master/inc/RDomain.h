@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 
+class DumpWriter;
+
 /**
  * @class Domain
  * @brief Abstract base class representing a computational domain.
@@ -30,7 +32,7 @@ public:
  * 
  * This class provides functionalities to:
  * - Generate simple 1D or rectangular grids.
- * - Print grid coordinates to a binary file using `fopen`, `fwrite`, and `fclose`.
+ * - Print grid coordinates to a binary file through a buffered DumpWriter.
  */
 class RDomain : public Domain {
 private:
@@ -67,6 +69,16 @@ public:
      */
     void PrintGrid(const std::string &outputFileName) const;
 
+    /**
+     * @brief Appends the grid coordinates to a buffered dump file
+     * 
+     * Same layout as PrintGrid(outputFileName), so repeated snapshots can
+     * share one file written in the background.
+     * 
+     * @param writer Open dump writer
+     */
+    void PrintGrid(DumpWriter &writer) const;
+
     /**
      * @brief Updates the grid spacing
      * 
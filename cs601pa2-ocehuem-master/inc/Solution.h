@@ -6,9 +6,12 @@
 #ifndef SOLUTION_H
 #define SOLUTION_H
 
+#include <string>
 #include "RDomain.h"
 #include "GridFn.h"
 
+class DumpWriter;
+
 /**
  * @class Solution
  * @brief Manages the numerical solution of a 2D thermal diffusion problem
@@ -20,12 +23,35 @@
  * numerical methods (likely finite differences).
  */
 class Solution {
+public:
+    /**
+     * @brief What Simulate() prints to standard output
+     */
+    enum OutputMode {
+        PRINT_STEPS,       ///< Error and all grid values every printEvery steps, and the converged solution
+        PRINT_CONVERGED,   ///< Only the converged solution
+        PRINT_SUMMARY      ///< One line with steps, final error and timing
+    };
+
 private:
     RDomain domain;      ///< Computational domain for the simulation
     GridFn gridFunction; ///< Grid function storing the temperature distribution
     double alpha;        ///< Thermal diffusivity coefficient
     double deltaT;       ///< Time step size
     int maxSteps;        ///< Maximum number of time steps to simulate
+    OutputMode outputMode;    ///< What Simulate() prints
+    int printEvery;           ///< Step cadence of PRINT_STEPS
+    std::string snapshotFile; ///< Binary snapshot file, written if snapshotEvery > 0
+    int snapshotEvery;        ///< Step cadence of snapshots, 0 for none
+    int checkEvery;           ///< Step cadence of the convergence check
+
+    /**
+     * @brief Append the current values to the snapshot file as one record
+     * 
+     * @param writer Open dump writer
+     * @param step Number of steps taken so far
+     */
+    void WriteSnapshot(DumpWriter &writer, int step) const;
 
 public:
     /**
@@ -49,12 +75,96 @@ public:
      */
     Solution(double len, double dx, double dt, double thermalDiff, int steps);
 
+    /**
+     * @brief Largest time step for which the explicit scheme is surely stable
+     * 
+     * The smaller of EstimatedStepLimit() and the Gershgorin limit
+     * dx^2/(2 alpha). The Lanczos estimate alone is not a guaranteed bound;
+     * 4 alpha/dx^2 bounds every eigenvalue of the operator.
+     * 
+     * @return double Largest stable time step
+     */
+    double StableTimeStep() const;
+
+    /**
+     * @brief Estimate of the stability limit of the explicit scheme
+     * 
+     * From the largest eigenvalue of the spatial operator with a few Lanczos
+     * iterations (GridFn::StableTimeStep()). Above it the solution grows; on
+     * coarse grids it is well above StableTimeStep().
+     * 
+     * @return double Estimated largest stable time step
+     */
+    double EstimatedStepLimit() const;
+
+    /**
+     * @brief Change the time step and the number of steps
+     * 
+     * @param dt Time step size
+     * @param steps Maximum number of time steps to simulate
+     */
+    void SetTimeStep(double dt, int steps);
+
+    /**
+     * @brief Reach a target end time in as few stable steps as possible
+     * 
+     * Uses ceil(endTime / StableTimeStep()) steps of equal size, which ends
+     * exactly at endTime with the largest step that is stable.
+     * 
+     * @param endTime Time to reach
+     * @return int Number of steps chosen
+     * @throws std::invalid_argument If endTime <= 0 or the step count overflows int
+     */
+    int FitTimeStep(double endTime);
+
+    /**
+     * @brief Choose what Simulate() prints
+     * 
+     * The default, PRINT_STEPS every step, prints every grid value on every
+     * step; on large grids formatting that output takes nearly all the time.
+     * 
+     * @param mode Output mode
+     * @param every Step cadence of PRINT_STEPS (step 0, every, 2 every, ...)
+     * @throws std::invalid_argument If every <= 0
+     */
+    void SetOutput(OutputMode mode, int every = 1);
+
+    /**
+     * @brief Check for convergence only every few steps
+     * 
+     * The change of the values is measured in the update sweep itself
+     * (GridFn::UpdateWithChange()); on the other steps the plain update runs.
+     * Steps printed by PRINT_STEPS and the last step are always measured.
+     * Convergence is then detected up to every - 1 steps late.
+     * 
+     * @param every Step cadence (steps every, 2 every, ...), default 1
+     * @throws std::invalid_argument If every <= 0
+     */
+    void SetConvergenceCheck(int every);
+
+    /**
+     * @brief Stream snapshots of the grid values to a binary file
+     * 
+     * Simulate() then writes the initial values, every \p every steps, and
+     * the last step through a DumpWriter, whose background thread does the
+     * disk writes while the time loop goes on. Each snapshot is one record:
+     * int32 step, int32 nx (number of grid points), double dx, double dt,
+     * then nx doubles. The time of a snapshot is step * dt, the position of
+     * value i is i * dx.
+     * 
+     * @param fileName Output file, truncated when Simulate() starts
+     * @param every Step cadence, 0 to turn snapshots off
+     * @throws std::invalid_argument If every < 0
+     */
+    void SetSnapshots(const std::string &fileName, int every);
+
     /**
      * @brief Executes the thermal diffusion simulation
      * 
      * Performs the time integration of the heat equation for the specified
      * number of time steps or until steady state is reached (if implemented).
      * The solution is updated in the gridFunction member variable.
+     * Console output follows SetOutput(), snapshots follow SetSnapshots().
      * 
      * @note The simulation uses an explicit time integration scheme
      *       (likely forward Euler) with central differences for spatial derivatives.
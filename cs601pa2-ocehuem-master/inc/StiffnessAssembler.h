@@ -0,0 +1,161 @@
+/**
+ * @file StiffnessAssembler.h
+ * @brief Sparse assembly of the global stiffness matrix over interior nodes
+ *
+ * Assembly is split into a symbolic phase, which derives the CSR sparsity
+ * pattern of the global matrix from the element connectivity together with the
+ * position in CSRMatrix::values() of every element matrix entry, and a numeric
+ * phase, which scatters element matrices straight into those positions.
+ */
+
+#ifndef STIFFNESSASSEMBLER_H_
+#define STIFFNESSASSEMBLER_H_
+
+#include <vector>
+#include "FEGrid.h"
+#include "CSRMatrix.h"
+#include "ElementColoring.h"
+#include "NodeOrdering.h"
+
+class DumpWriter;
+
+/**
+ * @class StiffnessAssembler
+ * @brief Builds the global stiffness matrix K_ij = B^T C B of a FEGrid in CSR form
+ *
+ * Rows and columns correspond to interior nodes, numbered in node order
+ * (globalMatrixIndex()) unless renumber() is called. Boundary nodes have no row.
+ */
+class StiffnessAssembler
+{
+public:
+  /**
+   * @brief Set up an assembler for a grid
+   *
+   * @param a_grid Grid to assemble over; must outlive the assembler
+   * @param a_cMatrix Row-major DIM x DIM material matrix C
+   */
+  StiffnessAssembler(const FEGrid& a_grid, const double a_cMatrix[DIM*DIM]);
+
+  /// @return Number of rows (interior nodes) of the global matrix
+  int getNumRows() const { return m_numRows; }
+
+  /**
+   * @brief Row of every node in the global matrix
+   *
+   * @return const std::vector<int>& Row index per node, -1 for boundary nodes
+   */
+  const std::vector<int>& globalMatrixIndex() const { return m_globalMatrixIndex; }
+
+  /**
+   * @brief Node of every row
+   *
+   * @return const std::vector<int>& Inverse of globalMatrixIndex() on interior nodes
+   */
+  const std::vector<int>& rowNode() const { return m_rowNode; }
+
+  /**
+   * @brief Permute the rows, e.g. by a bandwidth-reducing NodeOrdering
+   *
+   * Old row r becomes row a_ordering.oldToNew()[r]. symbolic() must be called
+   * (again) before assembling.
+   *
+   * @param a_ordering Permutation of the current rows
+   */
+  void renumber(const NodeOrdering& a_ordering);
+
+  /**
+   * @brief Scale every element matrix by the element area
+   *
+   * Off by default, matching the assignment's K. With it on, K is the
+   * Galerkin stiffness matrix of div(C grad u), as time-dependent problems
+   * combining K with a mass matrix need.
+   *
+   * @param a_areaWeighted Whether to include the area factor
+   */
+  void setAreaWeighted(bool a_areaWeighted) { m_areaWeighted = a_areaWeighted; }
+
+  /// @return Whether element matrices include the area factor
+  bool isAreaWeighted() const { return m_areaWeighted; }
+
+  /**
+   * @brief Symbolic phase: build the CSR pattern of the global matrix
+   *
+   * Row r holds the interior nodes sharing an element with the node of row r.
+   * Also records, for every element, where each of its VERTICES x VERTICES
+   * entries lives in a_K.values().
+   *
+   * @param[out] a_K Matrix receiving the pattern, values zeroed
+   */
+  void symbolic(CSRMatrix& a_K);
+
+  /**
+   * @brief Element stiffness matrix with boundary rows and columns masked to zero
+   *
+   * Allocation-free, fixed-size kernel (VERTICES x VERTICES); rows and columns
+   * of boundary nodes are zero rather than removed.
+   *
+   * @param a_eltNumber Element number
+   * @param[out] a_kij B^T C B (times the area if setAreaWeighted()), row-major VERTICES x VERTICES
+   * @param[out] a_kijpartial B^T C, row-major VERTICES x DIM
+   */
+  void elementMatrix(int a_eltNumber, double a_kij[VERTICES*VERTICES],
+                     double a_kijpartial[VERTICES*DIM]) const;
+
+  /**
+   * @brief Add an element matrix into the global matrix through the symbolic slots
+   *
+   * @param a_K Global matrix set up by symbolic()
+   * @param a_eltNumber Element number
+   * @param a_kij Element matrix from elementMatrix()
+   */
+  void scatter(CSRMatrix& a_K, int a_eltNumber, const double a_kij[VERTICES*VERTICES]) const;
+
+  /**
+   * @brief Numeric phase: zero a_K and add every element matrix into it
+   *
+   * @param a_K Global matrix set up by symbolic()
+   * @param a_dump If given, receives B^T C of every element as a block
+   *        (DumpWriter::writeBlock, id = element number, VERTICES*DIM values)
+   */
+  void assemble(CSRMatrix& a_K, DumpWriter* a_dump = nullptr) const;
+
+  /**
+   * @brief Parallel numeric phase using an element coloring
+   *
+   * Colors are processed one after another; the elements of one color share no
+   * node, hence no CSR entry, and are assembled by all threads without atomics.
+   *
+   * @param a_K Global matrix set up by symbolic()
+   * @param a_coloring Coloring of the grid's elements
+   * @param a_dump If given, receives B^T C of every element as in assemble();
+   *        blocks arrive in color order
+   */
+  void assembleColored(CSRMatrix& a_K, const ElementColoring& a_coloring,
+                       DumpWriter* a_dump = nullptr) const;
+
+  /**
+   * @brief Parallel numeric phase with one private copy of the values per thread
+   *
+   * Each thread scatters its share of the elements into its own zeroed copy of
+   * a_K.values(); the copies are then summed. Needs no coloring but
+   * threads x nonzeros extra memory.
+   *
+   * @param a_K Global matrix set up by symbolic()
+   */
+  void assembleThreadBuffers(CSRMatrix& a_K) const;
+
+  /// @return Bytes used by the row numbering and the element slot table
+  size_t memoryBytes() const;
+
+private:
+  const FEGrid& m_grid;                 ///< Grid being assembled
+  double m_cMatrix[DIM*DIM];            ///< Material matrix C
+  std::vector<int> m_globalMatrixIndex; ///< Row per node, -1 for boundary nodes
+  std::vector<int> m_rowNode;           ///< Node per row
+  int m_numRows;                        ///< Number of interior nodes
+  bool m_areaWeighted;                  ///< Element matrices scaled by the element area
+  std::vector<int> m_slots;             ///< VERTICES*VERTICES positions in values() per element, -1 if unused
+};
+
+#endif // STIFFNESSASSEMBLER_H_
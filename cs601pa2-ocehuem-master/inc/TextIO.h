@@ -0,0 +1,108 @@
+/**
+ * @file TextIO.h
+ * @brief Number parsing and formatting helpers shared by the mesh and matrix
+ *        readers and writers (MeshIO, MatrixIO)
+ */
+
+#ifndef TEXTIO_H_
+#define TEXTIO_H_
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/// Advance past spaces, tabs and carriage returns (not newlines)
+inline const char* skipBlanks(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    p++;
+  return p;
+}
+
+/// Advance past all whitespace including newlines
+inline const char* skipSpace(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+    p++;
+  return p;
+}
+
+/// Parse one number at p (after leading blanks); returns nullptr on failure
+template <typename T>
+inline const char* parseField(const char* p, const char* end, T& a_value) {
+  p = skipBlanks(p, end);
+  std::from_chars_result r = std::from_chars(p, end, a_value);
+  if (r.ec != std::errc())
+    return nullptr;
+  return r.ptr;
+}
+
+/// Move p to the first character of the next line (or end)
+inline const char* nextLine(const char* p, const char* end) {
+  const void* nl = memchr(p, '\n', end - p);
+  return nl ? static_cast<const char*>(nl) + 1 : end;
+}
+
+/**
+ * Write a_count lines to a_fp in batches. a_formatLine(i, buffer) appends line i
+ * (or any number of whole lines for record i) to buffer; each thread formats a
+ * contiguous slice of a batch into its own buffer and the buffers are written
+ * in thread order.
+ */
+template <typename LineFormatter>
+bool writeLinesParallel(FILE* a_fp, size_t a_count, LineFormatter a_formatLine) {
+  const size_t batch = 1 << 20;
+  int maxThreads = 1;
+#ifdef _OPENMP
+  maxThreads = omp_get_max_threads();
+#endif
+  std::unique_ptr<std::string[]> buffers(new std::string[maxThreads]);
+  bool ok = true;
+  for (size_t first = 0; first < a_count && ok; first += batch) {
+    size_t last = std::min(a_count, first + batch);
+    // the runtime may start fewer threads than requested; slice by the real team
+    int nthreads = 1;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(maxThreads)
+#endif
+    {
+      int tid = 0, team = 1;
+#ifdef _OPENMP
+      tid = omp_get_thread_num();
+      team = omp_get_num_threads();
+#endif
+      if (tid == 0)
+        nthreads = team;
+      std::string& buffer = buffers[tid];
+      buffer.clear();
+      size_t begin = first + (last - first) * tid / team;
+      size_t end = first + (last - first) * (tid + 1) / team;
+      for (size_t i = begin; i < end; i++)
+        a_formatLine(i, buffer);
+    }
+    for (int t = 0; t < nthreads && ok; t++)
+      ok = fwrite(buffers[t].data(), 1, buffers[t].size(), a_fp) == buffers[t].size();
+  }
+  return ok;
+}
+
+/// Append a number and a separator to a_buffer
+template <typename T>
+inline void appendField(std::string& a_buffer, T a_value, char a_separator) {
+  char text[32];
+  std::to_chars_result r = std::to_chars(text, text + sizeof(text), a_value);
+  a_buffer.append(text, r.ptr);
+  a_buffer.push_back(a_separator);
+}
+
+/// Round a byte offset up to the next multiple of 64
+inline uint64_t align64(uint64_t a_offset) {
+  return (a_offset + 63) & ~uint64_t(63);
+}
+
+#endif // TEXTIO_H_
@@ -0,0 +1,131 @@
+/**
+ * @file BandCholesky.cpp
+ * @brief Implementation of the blocked band Cholesky factorization and solves
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "BandCholesky.h"
+
+/**
+ * @brief Default constructor
+ */
+template <class Real>
+BandCholeskyT<Real>::BandCholeskyT() : m_numRows(0), m_kd(0) { }
+
+/**
+ * @brief Copy the lower band of a_K and factor it in place
+ * @param a_K Symmetric positive definite matrix
+ * @param a_blockSize Columns per block
+ * @details For each block of columns [k, k+kb):
+ *          1. the block columns are factored one by one, each updating only the
+ *             later columns of the same block;
+ *          2. the factored panel, rows [k, k+kb+kd) of those columns, is copied
+ *             into a dense row-major array;
+ *          3. the trailing band columns [k+kb, k+kb+kd) are updated with
+ *             A(i,c) -= sum_p L(i,p) L(c,p), the sum running contiguously over the
+ *             panel rows (the syrk/gemm step of dpbtrf).
+ */
+template <class Real>
+void BandCholeskyT<Real>::factor(const CSRMatrix& a_K, int a_blockSize) {
+  int n = a_K.getNumRows();
+  m_numRows = n;
+  m_kd = std::max(a_K.lowerBandwidth(), a_K.upperBandwidth());
+  int kd = m_kd;
+  m_ab.assign((size_t)(kd + 1) * n, Real(0));
+
+  const std::vector<int>& offsets = a_K.rowOffsets();
+  const std::vector<int>& columns = a_K.columns();
+  const AlignedVector<double>& values = a_K.values();
+  for (int i = 0; i < n; i++)
+    for (int k = offsets[i]; k < offsets[i + 1] && columns[k] <= i; k++)
+      at(i, columns[k]) = (Real)values[k];
+
+  int nb = std::max(1, std::min(a_blockSize, std::max(kd, 1)));
+  std::vector<Real> panel((size_t)(nb + kd) * nb);
+  for (int k = 0; k < n; k += nb)
+    {
+      int kb = std::min(nb, n - k);
+      // 1. unblocked factorization of the block columns
+      for (int j = k; j < k + kb; j++)
+        {
+          Real d = at(j, j);
+          if (!(d > Real(0)))
+            throw std::runtime_error("Band Cholesky: matrix is not positive definite");
+          d = std::sqrt(d);
+          at(j, j) = d;
+          int last = std::min(n - 1, j + kd);
+          for (int i = j + 1; i <= last; i++)
+            at(i, j) /= d;
+          for (int c = j + 1; c < std::min(k + kb, last + 1); c++)
+            {
+              Real lcj = at(c, j);
+              for (int i = c; i <= last; i++)
+                at(i, c) -= at(i, j) * lcj;
+            }
+        }
+      // 2. dense copy of the panel: rows [k, rowEnd), columns [k, k+kb)
+      int rowEnd = std::min(n, k + kb + kd);
+      for (int i = k; i < rowEnd; i++)
+        for (int p = k; p < k + kb; p++)
+          panel[(size_t)(i - k) * nb + (p - k)] = (i >= p && i - p <= kd) ? at(i, p) : Real(0);
+      // 3. update of the trailing band by the panel
+      for (int c = k + kb; c < rowEnd; c++)
+        {
+          const Real* lc = &panel[(size_t)(c - k) * nb];
+          int last = std::min(rowEnd - 1, c + kd);
+          for (int i = c; i <= last; i++)
+            {
+              const Real* li = &panel[(size_t)(i - k) * nb];
+              Real sum = 0;
+#pragma omp simd reduction(+:sum)
+              for (int p = 0; p < kb; p++)
+                sum += li[p] * lc[p];
+              at(i, c) -= sum;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Forward and backward substitution for every right-hand side
+ * @param[in,out] a_b Right-hand sides, then solutions
+ * @param a_numRHS Number of right-hand sides
+ * @details L y = b runs down the columns of the band (contiguous); L^T x = y uses
+ *          the same columns as rows of L^T. Right-hand sides are independent and
+ *          are solved in parallel.
+ */
+template <class Real>
+void BandCholeskyT<Real>::solve(Real* a_b, int a_numRHS) const {
+  int n = m_numRows;
+  int kd = m_kd;
+  const Real* ab = m_ab.data();
+#pragma omp parallel for schedule(static) if(a_numRHS > 1)
+  for (int r = 0; r < a_numRHS; r++)
+    {
+      Real* x = a_b + (size_t)r * n;
+      for (int j = 0; j < n; j++)
+        {
+          const Real* col = ab + (size_t)j * (kd + 1);
+          Real xj = x[j] / col[0];
+          x[j] = xj;
+          int len = std::min(kd, n - 1 - j);
+          for (int d = 1; d <= len; d++)
+            x[j + d] -= col[d] * xj;
+        }
+      for (int j = n - 1; j >= 0; j--)
+        {
+          const Real* col = ab + (size_t)j * (kd + 1);
+          int len = std::min(kd, n - 1 - j);
+          Real sum = x[j];
+          for (int d = 1; d <= len; d++)
+            sum -= col[d] * x[j + d];
+          x[j] = sum / col[0];
+        }
+    }
+}
+
+template class BandCholeskyT<double>;
+template class BandCholeskyT<float>;
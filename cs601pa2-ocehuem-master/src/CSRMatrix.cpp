@@ -0,0 +1,129 @@
+/**
+ * @file CSRMatrix.cpp
+ * @brief Implementation of the compressed sparse row matrix
+ */
+
+#include <algorithm>
+#include <cassert>
+#include "CSRMatrix.h"
+
+/**
+ * @brief Default constructor
+ */
+CSRMatrix::CSRMatrix() : m_numRows(0), m_rowOffsets(1, 0) { }
+
+/**
+ * @brief Set the sparsity pattern and zero the values
+ * @param a_numRows Number of rows
+ * @param a_rowOffsets Row offsets
+ * @param a_columns Sorted column indices
+ */
+void CSRMatrix::setPattern(int a_numRows, const std::vector<int>& a_rowOffsets,
+                           const std::vector<int>& a_columns) {
+  assert((int)a_rowOffsets.size() == a_numRows + 1);
+  assert(a_rowOffsets[a_numRows] == (int)a_columns.size());
+  m_numRows = a_numRows;
+  m_rowOffsets = a_rowOffsets;
+  m_columns = a_columns;
+  m_values.assign(m_columns.size(), 0.0);
+}
+
+/**
+ * @brief Zero the values
+ */
+void CSRMatrix::zero() {
+  std::fill(m_values.begin(), m_values.end(), 0.0);
+}
+
+/**
+ * @brief Locate an entry by binary search in its row
+ * @param a_row Row index
+ * @param a_column Column index
+ * @return Index into values(), or -1
+ */
+int CSRMatrix::find(int a_row, int a_column) const {
+  const int* begin = m_columns.data() + m_rowOffsets[a_row];
+  const int* end = m_columns.data() + m_rowOffsets[a_row + 1];
+  const int* it = std::lower_bound(begin, end, a_column);
+  if (it == end || *it != a_column)
+    return -1;
+  return it - m_columns.data();
+}
+
+/**
+ * @brief Value of an entry
+ * @param a_row Row index
+ * @param a_column Column index
+ * @return Stored value or zero
+ */
+double CSRMatrix::operator()(int a_row, int a_column) const {
+  int k = find(a_row, a_column);
+  return k < 0 ? 0.0 : m_values[k];
+}
+
+/**
+ * @brief Sparse matrix-vector product
+ * @param a_x Input vector
+ * @param[out] a_y Output vector, a_y = A a_x
+ */
+void CSRMatrix::multiply(const double* a_x, double* a_y) const {
+  const int* offsets = m_rowOffsets.data();
+  const int* cols = m_columns.data();
+  const double* vals = m_values.data();
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < m_numRows; i++)
+    {
+      double sum = 0.0;
+#pragma omp simd reduction(+:sum)
+      for (int k = offsets[i]; k < offsets[i + 1]; k++)
+        sum += vals[k] * a_x[cols[k]];
+      a_y[i] = sum;
+    }
+}
+
+/**
+ * @brief Lower bandwidth
+ * @return Largest row - column of a stored entry, 0 for an empty or upper triangular matrix
+ * @details Columns are sorted, so the first entry of each row decides.
+ */
+int CSRMatrix::lowerBandwidth() const {
+  int band = 0;
+  for (int i = 0; i < m_numRows; i++)
+    if (m_rowOffsets[i] < m_rowOffsets[i + 1])
+      band = std::max(band, i - m_columns[m_rowOffsets[i]]);
+  return band;
+}
+
+/**
+ * @brief Upper bandwidth
+ * @return Largest column - row of a stored entry
+ * @details The last entry of each row decides.
+ */
+int CSRMatrix::upperBandwidth() const {
+  int band = 0;
+  for (int i = 0; i < m_numRows; i++)
+    if (m_rowOffsets[i] < m_rowOffsets[i + 1])
+      band = std::max(band, m_columns[m_rowOffsets[i + 1] - 1] - i);
+  return band;
+}
+
+/**
+ * @brief Profile of the lower triangle
+ * @return Number of entries between the first stored column and the diagonal, summed over rows
+ */
+long CSRMatrix::profile() const {
+  long sum = 0;
+  for (int i = 0; i < m_numRows; i++)
+    if (m_rowOffsets[i] < m_rowOffsets[i + 1])
+      sum += std::max(0, i - m_columns[m_rowOffsets[i]]);
+  return sum;
+}
+
+/**
+ * @brief Memory footprint
+ * @return Bytes held by the row offsets, column indices and values
+ */
+size_t CSRMatrix::memoryBytes() const {
+  return m_rowOffsets.size()*sizeof(int) + m_columns.size()*sizeof(int) +
+    m_values.size()*sizeof(double);
+}
@@ -0,0 +1,247 @@
+/**
+ * @file ConjugateGradient.cpp
+ * @brief Implementation of the preconditioned conjugate gradient solver
+ */
+
+#include <cmath>
+#include <stdexcept>
+#include "ConjugateGradient.h"
+#include "Multigrid.h"
+
+/**
+ * @brief Dot product
+ * @param a_x First vector
+ * @param a_y Second vector
+ * @param a_n Length
+ * @return x . y
+ */
+static double dot(const double* a_x, const double* a_y, int a_n) {
+  double sum = 0.0;
+#pragma omp parallel for simd reduction(+:sum) schedule(static)
+  for (int i = 0; i < a_n; i++)
+    sum += a_x[i] * a_y[i];
+  return sum;
+}
+
+/**
+ * @brief Default constructor
+ */
+ConjugateGradient::ConjugateGradient()
+  : m_K(nullptr), m_preconditioner(NONE), m_multigrid(nullptr), m_relativeResidual(0.0), m_converged(false) { }
+
+/**
+ * @brief Set the matrix and build the preconditioner
+ * @param a_K Matrix
+ * @param a_preconditioner Preconditioner to build
+ * @details The work vectors are sized here so solve() does not allocate.
+ */
+void ConjugateGradient::setup(const CSRMatrix& a_K, Preconditioner a_preconditioner) {
+  m_K = &a_K;
+  m_preconditioner = a_preconditioner;
+  int n = a_K.getNumRows();
+  m_r.assign(n, 0.0);
+  m_z.assign(n, 0.0);
+  m_p.assign(n, 0.0);
+  m_q.assign(n, 0.0);
+  m_invDiag.clear();
+  m_lowerOffsets.clear();
+  m_lowerColumns.clear();
+  m_lowerValues.clear();
+  if (a_preconditioner == JACOBI)
+    {
+      m_invDiag.resize(n);
+      for (int i = 0; i < n; i++)
+        {
+          double d = a_K(i, i);
+          if (!(d > 0.0))
+            throw std::runtime_error("Jacobi preconditioner needs a positive diagonal");
+          m_invDiag[i] = 1.0 / d;
+        }
+    }
+  else if (a_preconditioner == IC0)
+    factorIC0();
+  else if (a_preconditioner == MULTIGRID && !m_multigrid)
+    throw std::runtime_error("Multigrid preconditioner needs setup(K, Multigrid)");
+}
+
+/**
+ * @brief Set the matrix and use a multigrid V-cycle as preconditioner
+ * @param a_K Matrix
+ * @param a_multigrid Hierarchy
+ */
+void ConjugateGradient::setup(const CSRMatrix& a_K, const Multigrid& a_multigrid) {
+  m_multigrid = &a_multigrid;
+  setup(a_K, MULTIGRID);
+}
+
+/**
+ * @brief Incomplete Cholesky factorization with zero fill
+ * @details Row i of L keeps the entries of row i of K with column <= i. Entry
+ *          L_ij = (K_ij - sum_{k<j} L_ik L_jk) / L_jj, the sum running over the
+ *          columns present in both rows (a merge of two sorted rows).
+ */
+void ConjugateGradient::factorIC0() {
+  const CSRMatrix& K = *m_K;
+  int n = K.getNumRows();
+  const std::vector<int>& offsets = K.rowOffsets();
+  const std::vector<int>& columns = K.columns();
+  const AlignedVector<double>& values = K.values();
+
+  m_lowerOffsets.assign(n + 1, 0);
+  for (int i = 0; i < n; i++)
+    {
+      for (int k = offsets[i]; k < offsets[i + 1] && columns[k] <= i; k++)
+        {
+          m_lowerColumns.push_back(columns[k]);
+          m_lowerValues.push_back(values[k]);
+        }
+      m_lowerOffsets[i + 1] = m_lowerColumns.size();
+      if (m_lowerOffsets[i + 1] == m_lowerOffsets[i] || m_lowerColumns.back() != i)
+        throw std::runtime_error("IC0 preconditioner needs every diagonal entry");
+    }
+
+  for (int i = 0; i < n; i++)
+    {
+      int rowEnd = m_lowerOffsets[i + 1] - 1;  // diagonal
+      for (int a = m_lowerOffsets[i]; a < rowEnd; a++)
+        {
+          int j = m_lowerColumns[a];
+          double sum = m_lowerValues[a];
+          int b = m_lowerOffsets[i], c = m_lowerOffsets[j];
+          while (b < a && m_lowerColumns[c] < j)
+            {
+              if (m_lowerColumns[b] < m_lowerColumns[c])
+                b++;
+              else if (m_lowerColumns[b] > m_lowerColumns[c])
+                c++;
+              else
+                sum -= m_lowerValues[b++] * m_lowerValues[c++];
+            }
+          m_lowerValues[a] = sum / m_lowerValues[m_lowerOffsets[j + 1] - 1];
+        }
+      double d = m_lowerValues[rowEnd];
+      for (int a = m_lowerOffsets[i]; a < rowEnd; a++)
+        d -= m_lowerValues[a] * m_lowerValues[a];
+      if (!(d > 0.0))
+        throw std::runtime_error("IC0 factorization broke down");
+      m_lowerValues[rowEnd] = std::sqrt(d);
+    }
+}
+
+/**
+ * @brief Apply the preconditioner
+ * @param a_r Residual
+ * @param[out] a_z M^{-1} r
+ * @details IC0 solves L y = r forward, then L^T z = y backward, using the rows of L
+ *          as the columns of L^T.
+ */
+void ConjugateGradient::precondition(const double* a_r, double* a_z) const {
+  int n = getNumRows();
+  if (m_preconditioner == JACOBI)
+    {
+      const double* invDiag = m_invDiag.data();
+#pragma omp parallel for simd schedule(static)
+      for (int i = 0; i < n; i++)
+        a_z[i] = invDiag[i] * a_r[i];
+    }
+  else if (m_preconditioner == IC0)
+    {
+      const int* offsets = m_lowerOffsets.data();
+      const int* cols = m_lowerColumns.data();
+      const double* vals = m_lowerValues.data();
+      for (int i = 0; i < n; i++)
+        {
+          double sum = a_r[i];
+          int diag = offsets[i + 1] - 1;
+          for (int k = offsets[i]; k < diag; k++)
+            sum -= vals[k] * a_z[cols[k]];
+          a_z[i] = sum / vals[diag];
+        }
+      for (int i = n - 1; i >= 0; i--)
+        {
+          int diag = offsets[i + 1] - 1;
+          a_z[i] /= vals[diag];
+          double zi = a_z[i];
+          for (int k = offsets[i]; k < diag; k++)
+            a_z[cols[k]] -= vals[k] * zi;
+        }
+    }
+  else if (m_preconditioner == MULTIGRID)
+    m_multigrid->precondition(a_r, a_z);
+  else
+    {
+#pragma omp parallel for simd schedule(static)
+      for (int i = 0; i < n; i++)
+        a_z[i] = a_r[i];
+    }
+}
+
+/**
+ * @brief Preconditioned conjugate gradient iteration
+ * @param a_b Right-hand side
+ * @param[in,out] a_x Initial guess, then solution
+ * @param a_tolerance Relative residual tolerance
+ * @param a_maxIterations Iteration limit
+ * @return Iterations done
+ * @details The updates of x and r and the residual norm share one pass over the vectors.
+ */
+int ConjugateGradient::solve(const double* a_b, double* a_x, double a_tolerance, int a_maxIterations) {
+  int n = getNumRows();
+  double* r = m_r.data();
+  double* z = m_z.data();
+  double* p = m_p.data();
+  double* q = m_q.data();
+
+  double bnorm = std::sqrt(dot(a_b, a_b, n));
+  if (bnorm == 0.0)
+    {
+      for (int i = 0; i < n; i++)
+        a_x[i] = 0.0;
+      m_relativeResidual = 0.0;
+      m_converged = true;
+      return 0;
+    }
+
+  m_K->multiply(a_x, q);
+  double rr = 0.0;
+#pragma omp parallel for simd reduction(+:rr) schedule(static)
+  for (int i = 0; i < n; i++)
+    {
+      r[i] = a_b[i] - q[i];
+      rr += r[i] * r[i];
+    }
+  precondition(r, z);
+  double rz = dot(r, z, n);
+#pragma omp parallel for simd schedule(static)
+  for (int i = 0; i < n; i++)
+    p[i] = z[i];
+
+  int it = 0;
+  m_relativeResidual = std::sqrt(rr) / bnorm;
+  while (m_relativeResidual > a_tolerance && it < a_maxIterations)
+    {
+      m_K->multiply(p, q);
+      double alpha = rz / dot(p, q, n);
+      rr = 0.0;
+#pragma omp parallel for simd reduction(+:rr) schedule(static)
+      for (int i = 0; i < n; i++)
+        {
+          a_x[i] += alpha * p[i];
+          r[i] -= alpha * q[i];
+          rr += r[i] * r[i];
+        }
+      it++;
+      m_relativeResidual = std::sqrt(rr) / bnorm;
+      if (m_relativeResidual <= a_tolerance)
+        break;
+      precondition(r, z);
+      double rzNew = dot(r, z, n);
+      double beta = rzNew / rz;
+      rz = rzNew;
+#pragma omp parallel for simd schedule(static)
+      for (int i = 0; i < n; i++)
+        p[i] = z[i] + beta * p[i];
+    }
+  m_converged = m_relativeResidual <= a_tolerance;
+  return it;
+}
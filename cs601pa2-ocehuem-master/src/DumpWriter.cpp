@@ -0,0 +1,130 @@
+/**
+ * @file DumpWriter.cpp
+ * @brief Implementation of the double-buffered background dump writer
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include "DumpWriter.h"
+
+/**
+ * @brief Open the file and start the writer thread
+ * @param a_fileName Path of the file
+ * @param a_bufferBytes Size of each buffer
+ */
+DumpWriter::DumpWriter(const std::string& a_fileName, size_t a_bufferBytes)
+  : m_file(nullptr), m_capacity(std::max<size_t>(a_bufferBytes, 64)), m_bytesWritten(0),
+    m_pending(false), m_stop(false), m_failed(false) {
+  m_file = fopen(a_fileName.c_str(), "wb");
+  if (!m_file)
+    throw std::runtime_error("Cannot create " + a_fileName);
+  m_front.reserve(m_capacity);
+  m_back.reserve(m_capacity);
+  m_writer = std::thread(&DumpWriter::writerLoop, this);
+}
+
+/**
+ * @brief Flush and close; errors are dropped since destructors must not throw
+ */
+DumpWriter::~DumpWriter() {
+  try
+    {
+      close();
+    }
+  catch (const std::exception&)
+    {
+    }
+}
+
+/**
+ * @brief Append raw bytes, handing off full buffers
+ * @param a_data Bytes to append
+ * @param a_bytes Number of bytes
+ */
+void DumpWriter::write(const void* a_data, size_t a_bytes) {
+  const char* p = static_cast<const char*>(a_data);
+  m_bytesWritten += a_bytes;
+  while (a_bytes > 0)
+    {
+      if (m_front.size() == m_capacity)
+        handOff();
+      size_t n = std::min(a_bytes, m_capacity - m_front.size());
+      m_front.insert(m_front.end(), p, p + n);
+      p += n;
+      a_bytes -= n;
+    }
+}
+
+/**
+ * @brief Append one block record
+ * @param a_id Identifier of the block
+ * @param a_values Values of the block
+ * @param a_count Number of values
+ */
+void DumpWriter::writeBlock(int a_id, const double* a_values, int a_count) {
+  int32_t header[2] = {a_id, a_count};
+  write(header, sizeof(header));
+  write(a_values, sizeof(double) * a_count);
+}
+
+/**
+ * @brief Hand off the current buffer if it holds data
+ */
+void DumpWriter::flush() {
+  if (!m_front.empty())
+    handOff();
+}
+
+/**
+ * @brief Swap buffers once the writer is idle and wake it up
+ * @details The caller only blocks if the disk is slower than the caller fills a buffer.
+ */
+void DumpWriter::handOff() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this] { return !m_pending; });
+    std::swap(m_front, m_back);
+    m_pending = true;
+  }
+  m_cond.notify_all();
+  m_front.clear();
+}
+
+/**
+ * @brief Body of the writer thread
+ */
+void DumpWriter::writerLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+    {
+      m_cond.wait(lock, [this] { return m_pending || m_stop; });
+      if (!m_pending)
+        break;
+      lock.unlock();
+      bool ok = fwrite(m_back.data(), 1, m_back.size(), m_file) == m_back.size();
+      lock.lock();
+      m_failed = m_failed || !ok;
+      m_back.clear();
+      m_pending = false;
+      m_cond.notify_all();
+    }
+}
+
+/**
+ * @brief Write out the remaining data and close the file
+ */
+void DumpWriter::close() {
+  if (!m_file)
+    return;
+  flush();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cond.notify_all();
+  m_writer.join();
+  bool failed = m_failed || fclose(m_file) != 0;
+  m_file = nullptr;
+  if (failed)
+    throw std::runtime_error("Writing a dump file failed");
+}
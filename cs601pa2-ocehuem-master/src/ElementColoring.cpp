@@ -0,0 +1,60 @@
+/**
+ * @file ElementColoring.cpp
+ * @brief Implementation of greedy element coloring
+ */
+
+#include <vector>
+#include "ElementColoring.h"
+
+/**
+ * @brief Default constructor
+ */
+ElementColoring::ElementColoring() : m_colorOffsets(1, 0) { }
+
+/**
+ * @brief Greedy distance-1 coloring of the node-sharing element graph
+ * @param a_grid Grid whose elements are colored
+ * @details A forbidden-color table stamped with the current element number avoids
+ *          clearing it between elements; the cost is O(elements x elements per node).
+ */
+void ElementColoring::build(const FEGrid& a_grid) {
+  const MeshTopology& topo = a_grid.topology();
+  const std::vector<int>& nodeEltOffsets = topo.nodeEltOffsets();
+  const std::vector<int>& nodeElts = topo.nodeElts();
+  int ncell = a_grid.getNumElts();
+
+  m_color.assign(ncell, -1);
+  std::vector<int> forbidden;
+  int numColors = 0;
+  for (int i = 0; i < ncell; i++)
+    {
+      const Element& e = a_grid.element(i);
+      for (int ivert = 0; ivert < VERTICES; ivert++)
+        for (int k = nodeEltOffsets[e[ivert]]; k < nodeEltOffsets[e[ivert] + 1]; k++)
+          {
+            int c = m_color[nodeElts[k]];
+            if (c >= 0)
+              forbidden[c] = i;
+          }
+      int c = 0;
+      while (c < numColors && forbidden[c] == i)
+        c++;
+      if (c == numColors)
+        {
+          numColors++;
+          forbidden.push_back(-1);
+        }
+      m_color[i] = c;
+    }
+
+  // Group elements by color (counting sort keeps element order within a color)
+  m_colorOffsets.assign(numColors + 1, 0);
+  for (int i = 0; i < ncell; i++)
+    m_colorOffsets[m_color[i] + 1]++;
+  for (int c = 0; c < numColors; c++)
+    m_colorOffsets[c + 1] += m_colorOffsets[c];
+  m_elts.resize(ncell);
+  std::vector<int> fill(m_colorOffsets.begin(), m_colorOffsets.end() - 1);
+  for (int i = 0; i < ncell; i++)
+    m_elts[fill[m_color[i]]++] = i;
+}
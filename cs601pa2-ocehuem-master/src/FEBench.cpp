@@ -0,0 +1,1423 @@
+/**
+ * @file FEBench.cpp
+ * @brief Benchmarks for the finite element mesh and assembly code
+ *
+ * Usage: ./febench <prefix of .node/.elem files> [section]
+ * Each section times one part of the FE pipeline and prints one line per variant.
+ * Without a section name all sections are run.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "FEGrid.h"
+#include "MeshIO.h"
+#include "CSRMatrix.h"
+#include "StiffnessAssembler.h"
+#include "ElementColoring.h"
+#include "DumpWriter.h"
+#include "NodeOrdering.h"
+#include "ConjugateGradient.h"
+#include "BandCholesky.h"
+#include "Multigrid.h"
+#include "MeshPartition.h"
+#include "MatrixIO.h"
+#include "MatrixFreeStiffness.h"
+#include "MeshReordering.h"
+#include "Lanczos.h"
+#include "HeatSolver.h"
+#include "MixedPrecisionSolver.h"
+#include "GridFn.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t);
+/** @brief Number of malloc calls so far, counted by the malloc below */
+static std::atomic<long> mallocCount(0);
+
+/**
+ * @brief Counting malloc; operator new and std::vector end up here as well
+ */
+extern "C" void* malloc(size_t a_bytes) {
+  mallocCount.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(a_bytes);
+}
+#define FE_COUNTS_ALLOCATIONS 1
+#endif
+
+/**
+ * @brief Heap allocations made so far, -1 where they are not counted
+ */
+static long allocationCount() {
+#ifdef FE_COUNTS_ALLOCATIONS
+  return mallocCount.load();
+#else
+  return -1;
+#endif
+}
+
+/**
+ * @brief Seconds elapsed since a_start
+ */
+static double secondsSince(const std::chrono::steady_clock::time_point& a_start) {
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - a_start;
+  return elapsed.count();
+}
+
+/**
+ * @brief Reference reader: the ifstream/atof loop FEGrid used before MeshIO
+ */
+static void readMeshIfstream(const string& a_nodeFile, const string& a_eleFile, MeshData& a_mesh) {
+  ifstream nodes(a_nodeFile.c_str());
+  int ncount;
+  nodes>>ncount;
+  a_mesh.x.resize(ncount);
+  a_mesh.y.resize(ncount);
+  a_mesh.boundary.clear();
+  for(int i=0; i<ncount; i++) {
+    int vertex;
+    std::string tmp[DIM];
+    nodes>>vertex>>tmp[0]>>tmp[1];
+    a_mesh.x[vertex-1]=atof(tmp[0].c_str());
+    a_mesh.y[vertex-1]=atof(tmp[1].c_str());
+  }
+  ifstream elements(a_eleFile.c_str());
+  int ncell;
+  elements>>ncell;
+  a_mesh.vertices.resize(ncell*VERTICES);
+  for(int i=0; i<ncell; i++) {
+    int cellID, vert[VERTICES];
+    elements>>cellID>>vert[0]>>vert[1]>>vert[2];
+    for(int ivert=0; ivert<VERTICES; ivert++)
+      a_mesh.vertices[(cellID-1)*VERTICES+ivert] = vert[ivert]-1;
+  }
+}
+
+/**
+ * @brief Mesh loading: ifstream reference, mmap/from_chars text parser, .femesh cache
+ */
+static void benchLoad(const string& a_prefix) {
+  string nodeFile = a_prefix+".node";
+  string eleFile  = a_prefix+".elem";
+  string cacheFile = a_prefix+".bench.femesh";
+  MeshData ref, text, cached;
+
+  auto start = std::chrono::steady_clock::now();
+  readMeshIfstream(nodeFile, eleFile, ref);
+  double tIfstream = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  readTextMesh(nodeFile, eleFile, text);
+  double tText = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  bool written = writeMeshCache(cacheFile, text);
+  double tWrite = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  bool read = written && readMeshCache(cacheFile, cached);
+  double tCache = secondsSince(start);
+
+  // What FEGrid does: map and validate, then read the arrays in place
+  std::unique_ptr<MappedFile> mapping;
+  MeshView view;
+  start = std::chrono::steady_clock::now();
+  bool mapped = written && mapMeshCache(cacheFile, mapping, view);
+  double tMap = secondsSince(start);
+  mapped = mapped && view.numNodes == text.numNodes() && view.numElts == text.numElts() &&
+    std::equal(text.x.begin(), text.x.end(), view.x);
+  mapping.reset();
+  remove(cacheFile.c_str());
+
+  bool same = ref.x == text.x && ref.y == text.y && ref.vertices == text.vertices &&
+    read && cached.x == text.x && cached.vertices == text.vertices && mapped;
+  cout<<"load "<<a_prefix<<": "<<text.numNodes()<<" nodes, "<<text.numElts()<<" elements"
+      <<(same ? "" : " (MISMATCH)")<<endl;
+  cout<<"  ifstream+atof      "<<tIfstream<<" s"<<endl;
+  cout<<"  mmap+from_chars    "<<tText<<" s"<<endl;
+  cout<<"  .femesh write      "<<tWrite<<" s"<<endl;
+  cout<<"  .femesh map+check  "<<tMap<<" s (FEGrid reads the mapped arrays in place)"<<endl;
+  cout<<"  .femesh to MeshData "<<tCache<<" s (map+check, then "<<tCache - tMap<<" s copying)"<<endl;
+}
+
+/**
+ * @brief Topology build time and the resulting boundary classification
+ */
+static void benchTopology(const FEGrid& a_grid) {
+  vector<Element> elements(a_grid.getNumElts());
+  for(int i=0; i<a_grid.getNumElts(); i++)
+    elements[i] = a_grid.element(i);
+  MeshTopology topo;
+  auto start = std::chrono::steady_clock::now();
+  topo.build(a_grid.getNumNodes(), elements);
+  double t = secondsSince(start);
+  cout<<"topology: "<<topo.getNumBoundaryEdges()<<" boundary edges, "
+      <<a_grid.getNumInteriorNodes()<<" interior nodes, build "<<t<<" s"<<endl;
+}
+
+/**
+ * @brief Element geometry: per-call elementArea()/gradient() against the bulk SoA kernels
+ * @details Each variant sweeps all elements a_repeat times; rates are in elements per second.
+ */
+static void benchGeometry(const FEGrid& a_grid, int a_repeat) {
+  int ncell = a_grid.getNumElts();
+  // magnitudes are summed: the three gradients of an element cancel
+  vector<double> areas(ncell), gx(VERTICES*ncell), gy(VERTICES*ncell);
+
+  double sumCall = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(int r=0; r<a_repeat; r++)
+    for(int i=0; i<ncell; i++) {
+      sumCall += a_grid.elementArea(i);
+      for(int j=0; j<VERTICES; j++) {
+        double g[DIM];
+        a_grid.gradient(g, i, j);
+        sumCall += fabs(g[0]) + fabs(g[1]);
+      }
+    }
+  double tCall = secondsSince(start);
+
+  double sumBulk = 0;
+  start = std::chrono::steady_clock::now();
+  for(int r=0; r<a_repeat; r++) {
+    a_grid.elementAreas(areas.data());
+    a_grid.gradients(gx.data(), gy.data());
+    for(int i=0; i<ncell; i++)
+      sumBulk += areas[i] + fabs(gx[i]) + fabs(gx[ncell+i]) + fabs(gx[2*ncell+i])
+          + fabs(gy[i]) + fabs(gy[ncell+i]) + fabs(gy[2*ncell+i]);
+  }
+  double tBulk = secondsSince(start);
+
+  FEGrid cached(a_grid);
+  start = std::chrono::steady_clock::now();
+  cached.buildGeometryCache();
+  double tBuild = secondsSince(start);
+  double sumCached = 0;
+  start = std::chrono::steady_clock::now();
+  for(int r=0; r<a_repeat; r++)
+    for(int i=0; i<ncell; i++) {
+      sumCached += cached.cachedArea(i);
+      for(int j=0; j<VERTICES; j++) {
+        double g[DIM];
+        cached.cachedGradient(g, i, j);
+        sumCached += fabs(g[0]) + fabs(g[1]);
+      }
+    }
+  double tCached = secondsSince(start);
+
+  double elts = (double)ncell*a_repeat;
+  cout<<"geometry: area + 3 gradients per element, "<<a_repeat<<" sweeps"
+      <<(fabs(sumCall-sumBulk) <= 1e-9*fabs(sumCall) &&
+        fabs(sumCall-sumCached) <= 1e-9*fabs(sumCall) ? "" : " (MISMATCH)")<<endl;
+  cout<<"  per-call API       "<<elts/tCall<<" elements/s"<<endl;
+  cout<<"  SoA bulk kernels   "<<elts/tBulk<<" elements/s"<<endl;
+  cout<<"  geometry cache     "<<elts/tCached<<" elements/s (build "<<tBuild<<" s)"<<endl;
+}
+
+/** @brief Material matrix used by FEMain (K=30 on the diagonal) */
+static const double benchCMatrix[DIM*DIM] = {30, 0, 0, 30};
+
+/**
+ * @brief Element stiffness loop as FEMain had it: element copy, interior node
+ *        vector, malloc'd B^T and B, explicit transpose
+ * @return Sum of all entries, so the work is not optimized away
+ */
+static double legacyElementLoop(const FEGrid& a_grid, const double a_cMatrix[DIM*DIM]) {
+  double kij[VERTICES*VERTICES], kijpartial[VERTICES*DIM];
+  double checksum = 0;
+  for(int i=0;i<a_grid.getNumElts();i++) {
+    Element e=a_grid.element(i);
+    std::vector<int> elementInteriorNodeID;
+    for(int j=0;j<VERTICES;j++)
+      if(a_grid.node(e[j]).isInterior())
+        elementInteriorNodeID.push_back(j);
+    int n = elementInteriorNodeID.size();
+    double* bMatrixTrans=(double *)malloc(sizeof(double)*n*DIM);
+    for(int j=0;j<n;j++)
+      a_grid.gradient(bMatrixTrans+j*DIM, i, elementInteriorNodeID[j]);
+    for(int m=0;m<n;m++)
+      for(int c=0;c<DIM;c++) {
+        kijpartial[m*DIM+c]=0.;
+        for(int r=0;r<DIM;r++)
+          kijpartial[m*DIM+c] += bMatrixTrans[m*DIM+r] * a_cMatrix[r*DIM+c];
+      }
+    double *bMatrix=(double *)malloc(sizeof(double)*DIM*n);
+    for(int m=0;m<DIM;m++)
+      for(int c=0;c<n;c++)
+        bMatrix[m*n+c]=bMatrixTrans[c*DIM+m];
+    free(bMatrixTrans);
+    for(int m=0;m<n;m++)
+      for(int c=0;c<n;c++) {
+        kij[m*n+c]=0.;
+        for(int r=0;r<DIM;r++)
+          kij[m*n+c] += kijpartial[m*DIM+r] * bMatrix[r*n+c];
+        checksum += kij[m*n+c];
+      }
+    free(bMatrix);
+  }
+  return checksum;
+}
+
+/**
+ * @brief Element kernel: the old allocating loop against StiffnessAssembler::elementMatrix
+ * @param a_repeat Number of sweeps over the elements
+ */
+static void benchKernel(const FEGrid& a_grid, int a_repeat) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  double kij[VERTICES*VERTICES], kijpartial[VERTICES*DIM];
+  double elts = (double)a_grid.getNumElts()*a_repeat;
+
+  double legacySum = 0;
+  long allocs = allocationCount();
+  auto start = std::chrono::steady_clock::now();
+  for(int r=0; r<a_repeat; r++)
+    legacySum += legacyElementLoop(a_grid, benchCMatrix);
+  double tLegacy = secondsSince(start);
+  long legacyAllocs = allocationCount() - allocs;
+
+  double sum = 0;
+  allocs = allocationCount();
+  start = std::chrono::steady_clock::now();
+  for(int r=0; r<a_repeat; r++)
+    for(int i=0; i<a_grid.getNumElts(); i++) {
+      assembler.elementMatrix(i, kij, kijpartial);
+      for(int k=0; k<VERTICES*VERTICES; k++)
+        sum += kij[k];
+    }
+  double tKernel = secondsSince(start);
+  long kernelAllocs = allocationCount() - allocs;
+
+  cout<<"kernel: "<<a_grid.getNumElts()<<" elements x "<<a_repeat<<", checksum difference "
+      <<fabs(sum - legacySum)/std::max(1.0, fabs(legacySum))<<endl;
+  if(legacyAllocs < 0)
+    cout<<"  (allocation counting not available on this platform)"<<endl;
+  cout<<"  malloc/transpose   "<<elts/tLegacy<<" elements/s, "<<legacyAllocs/elts<<" allocations/element"<<endl;
+  cout<<"  fixed-size kernel  "<<elts/tKernel<<" elements/s, "<<kernelAllocs/elts<<" allocations/element"<<endl;
+}
+
+/**
+ * @brief Global assembly: dense numInteriorNodes^2 array against symbolic + numeric CSR
+ */
+static void benchAssemble(const FEGrid& a_grid) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  int numRows = assembler.getNumRows();
+  const vector<int>& index = assembler.globalMatrixIndex();
+  double kij[VERTICES*VERTICES], kijpartial[VERTICES*DIM];
+
+  // Dense reference, as FEMain did before CSR assembly. It is O(n^2) bytes; skip
+  // it where it would be gigabytes
+  size_t denseBytes = sizeof(double)*(size_t)numRows*numRows;
+  double* dense = NULL;
+  double tDense = 0;
+  if(numRows <= 20000) {
+    auto start = std::chrono::steady_clock::now();
+    dense = (double*)malloc(denseBytes);
+    if(dense != NULL) {
+      memset(dense, 0, denseBytes);
+      for(int i=0; i<a_grid.getNumElts(); i++) {
+        assembler.elementMatrix(i, kij, kijpartial);
+        const Element& e = a_grid.element(i);
+        for(int m=0; m<VERTICES; m++)
+          for(int c=0; c<VERTICES; c++)
+            if(index[e[m]] >= 0 && index[e[c]] >= 0)
+              dense[(size_t)index[e[m]]*numRows + index[e[c]]] += kij[m*VERTICES+c];
+      }
+    }
+    tDense = secondsSince(start);
+  }
+
+  CSRMatrix K;
+  auto start = std::chrono::steady_clock::now();
+  assembler.symbolic(K);
+  double tSymbolic = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  assembler.assemble(K);
+  double tNumeric = secondsSince(start);
+
+  cout<<"assemble: "<<numRows<<" rows, "<<K.getNumNonzeros()<<" nonzeros ("
+      <<(double)K.getNumNonzeros()/std::max(1, numRows)<<" per row)";
+  if(dense != NULL) {
+    // compare full rows at a fixed stride, at most about 256 of them
+    int stride = std::max(1, numRows/256);
+    double maxDiff = 0;
+    for(int r=0; r<numRows; r+=stride)
+      for(int c=0; c<numRows; c++)
+        maxDiff = std::max(maxDiff, fabs(dense[(size_t)r*numRows+c] - K(r, c)));
+    free(dense);
+    cout<<", max |dense-CSR| "<<maxDiff<<" over "<<(numRows+stride-1)/stride<<" sampled rows"<<endl;
+    cout<<"  dense              "<<tDense<<" s, "<<denseBytes<<" bytes"<<endl;
+  }
+  else {
+    cout<<endl;
+    if(numRows <= 20000)
+      cout<<"  dense              skipped (could not allocate "<<denseBytes<<" bytes)"<<endl;
+    else
+      cout<<"  dense              skipped (n > 20000, would be "<<denseBytes<<" bytes)"<<endl;
+  }
+  cout<<"  CSR symbolic       "<<tSymbolic<<" s"<<endl;
+  cout<<"  CSR numeric        "<<tNumeric<<" s, "<<K.memoryBytes()<<" bytes + "
+      <<assembler.memoryBytes()<<" bytes of slots"<<endl;
+}
+
+/**
+ * @brief Serial assembly with the element B^T C dump off, through DumpWriter, and
+ *        as one open/write/close of kijdump.bin per element (the old FEMain)
+ * @param a_repeat Number of assemblies per variant
+ */
+static void benchDump(const FEGrid& a_grid, int a_repeat) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  CSRMatrix K;
+  assembler.symbolic(K);
+  const string dumpFile = "febench_dump.bin";
+  double kij[VERTICES*VERTICES], kijpartial[VERTICES*DIM];
+
+  auto start = std::chrono::steady_clock::now();
+  for(int r=0; r<a_repeat; r++)
+    assembler.assemble(K);
+  double tOff = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  size_t bytes = 0;
+  {
+    DumpWriter dump(dumpFile);
+    for(int r=0; r<a_repeat; r++)
+      assembler.assemble(K, &dump);
+    dump.close();
+    bytes = dump.bytesWritten();
+  }
+  double tBuffered = secondsSince(start);
+
+  // per-element files are slow; one assembly is enough
+  start = std::chrono::steady_clock::now();
+  K.zero();
+  for(int i=0; i<a_grid.getNumElts(); i++) {
+    assembler.elementMatrix(i, kij, kijpartial);
+    assembler.scatter(K, i, kij);
+    ofstream kijDump(dumpFile, ios::binary);
+    kijDump.write(reinterpret_cast<const char*>(kijpartial), sizeof(double)*VERTICES*DIM);
+    kijDump.close();
+  }
+  double tPerElement = secondsSince(start)*a_repeat;
+  remove(dumpFile.c_str());
+
+  cout<<"dump: "<<a_grid.getNumElts()<<" elements x "<<a_repeat<<" assemblies, "
+      <<bytes/a_repeat<<" bytes of blocks per assembly"<<endl;
+  cout<<"  no dump            "<<tOff/a_repeat<<" s per assembly"<<endl;
+  cout<<"  DumpWriter         "<<tBuffered/a_repeat<<" s per assembly, "
+      <<bytes/tBuffered/1e6<<" MB/s"<<endl;
+  cout<<"  file per element   "<<tPerElement/a_repeat<<" s per assembly"<<endl;
+}
+
+/**
+ * @brief Assemble K in one row order and time repeated SpMV
+ * @param a_name Label of the order
+ * @param a_ordering Rows relative to file order
+ * @param a_repeat Number of products
+ * @param[in,out] a_yRef K x in file order; filled by the first call, compared against later
+ * @return Seconds per product
+ */
+static double benchOrdering(const FEGrid& a_grid, const string& a_name, const NodeOrdering& a_ordering,
+                            int a_repeat, vector<double>& a_yRef) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  assembler.renumber(a_ordering);
+  CSRMatrix K;
+  assembler.symbolic(K);
+  assembler.assemble(K);
+  int n = K.getNumRows();
+  const vector<int>& newToOld = a_ordering.newToOld();
+  vector<double> x(n), y(n);
+  for(int r=0; r<n; r++)
+    x[r] = sin(0.1*newToOld[r]);
+
+  auto start = std::chrono::steady_clock::now();
+  for(int k=0; k<a_repeat; k++)
+    K.multiply(x.data(), y.data());
+  double t = secondsSince(start)/a_repeat;
+
+  double maxDiff = 0, yScale = 0;
+  if(a_yRef.empty()) {
+    a_yRef.resize(n);
+    for(int r=0; r<n; r++)
+      a_yRef[newToOld[r]] = y[r];
+  }
+  for(int r=0; r<n; r++) {
+    maxDiff = std::max(maxDiff, fabs(y[r] - a_yRef[newToOld[r]]));
+    yScale = std::max(yScale, fabs(a_yRef[r]));
+  }
+  cout<<"  "<<a_name<<"bandwidth "<<K.lowerBandwidth()<<"/"<<K.upperBandwidth()
+      <<", profile "<<K.profile()<<", SpMV "<<t<<" s"<<(maxDiff <= 1e-12*yScale ? "" : " (MISMATCH)")<<endl;
+  return t;
+}
+
+/**
+ * @brief Bandwidth, profile and SpMV time in file order, a random order, and RCM of the random order
+ * @param a_repeat Number of products per order
+ */
+static void benchRCM(const FEGrid& a_grid, int a_repeat) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  int n = assembler.getNumRows();
+  vector<int> order(n);
+  for(int r=0; r<n; r++)
+    order[r] = r;
+  NodeOrdering fileOrder;
+  fileOrder.set(order);
+
+  // random order: how a mesh generator without locality would number the nodes
+  std::mt19937 gen(2024);
+  std::shuffle(order.begin(), order.end(), gen);
+  NodeOrdering randomOrder;
+  randomOrder.set(order);
+  StiffnessAssembler randomAssembler(a_grid, benchCMatrix);
+  randomAssembler.renumber(randomOrder);
+  CSRMatrix randomK;
+  randomAssembler.symbolic(randomK);
+
+  NodeOrdering rcm;
+  auto start = std::chrono::steady_clock::now();
+  rcm.buildRCM(randomK);
+  double tRCM = secondsSince(start);
+  // compose: RCM rows -> random rows -> file rows
+  for(int r=0; r<n; r++)
+    order[r] = randomOrder.newToOld()[rcm.newToOld()[r]];
+  NodeOrdering rcmOrder;
+  rcmOrder.set(order);
+
+  cout<<"rcm: "<<n<<" rows, RCM "<<tRCM<<" s"<<endl;
+  vector<double> yRef;
+  double tFile = benchOrdering(a_grid, "file order         ", fileOrder, a_repeat, yRef);
+  double tRandom = benchOrdering(a_grid, "random order       ", randomOrder, a_repeat, yRef);
+  double tOrdered = benchOrdering(a_grid, "RCM of random      ", rcmOrder, a_repeat, yRef);
+  cout<<"  SpMV speedup of RCM: "<<tRandom/tOrdered<<" over random, "<<tFile/tOrdered<<" over file order"<<endl;
+}
+
+/**
+ * @brief Assembled stiffness matrix of a grid in RCM order, as FEMain solves it
+ */
+static void assembleRCM(const FEGrid& a_grid, CSRMatrix& a_K) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  assembler.symbolic(a_K);
+  NodeOrdering rcm;
+  rcm.buildRCM(a_K);
+  assembler.renumber(rcm);
+  assembler.symbolic(a_K);
+  assembler.assemble(a_K);
+}
+
+/**
+ * @brief ||b - K x|| / ||b||, computed independently of the solver
+ */
+static double relativeResidual(const CSRMatrix& a_K, const vector<double>& a_b, const vector<double>& a_x) {
+  vector<double> kx(a_b.size());
+  a_K.multiply(a_x.data(), kx.data());
+  double rr = 0, bb = 0;
+  for(size_t i=0; i<a_b.size(); i++) {
+    rr += (a_b[i]-kx[i])*(a_b[i]-kx[i]);
+    bb += a_b[i]*a_b[i];
+  }
+  return sqrt(rr/bb);
+}
+
+/**
+ * @brief CG with each preconditioner: setup, iterations and time to 1e-10
+ * @param a_numRHS Number of right-hand sides solved with one setup
+ */
+static void benchCG(const FEGrid& a_grid, int a_numRHS) {
+  CSRMatrix K;
+  assembleRCM(a_grid, K);
+  int n = K.getNumRows();
+  const double tolerance = 1e-10;
+  cout<<"cg: "<<n<<" rows, "<<K.getNumNonzeros()<<" nonzeros, tolerance "<<tolerance
+      <<", "<<a_numRHS<<" right-hand sides"<<endl;
+
+  const char* names[] = {"none               ", "Jacobi             ", "IC0                "};
+  ConjugateGradient::Preconditioner types[] = {ConjugateGradient::NONE, ConjugateGradient::JACOBI,
+                                               ConjugateGradient::IC0};
+  vector<double> b(n), x(n);
+  for(int p=0; p<3; p++) {
+    ConjugateGradient cg;
+    auto start = std::chrono::steady_clock::now();
+    cg.setup(K, types[p]);
+    double tSetup = secondsSince(start);
+    long iterations = 0;
+    double worst = 0;
+    start = std::chrono::steady_clock::now();
+    for(int k=0; k<a_numRHS; k++) {
+      for(int i=0; i<n; i++)
+        b[i] = 1.0 + 0.5*sin(0.37*i + k);
+      std::fill(x.begin(), x.end(), 0.0);
+      iterations += cg.solve(b.data(), x.data(), tolerance, 10*n+100);
+      worst = std::max(worst, relativeResidual(K, b, x));
+    }
+    double tSolve = secondsSince(start)/a_numRHS;
+    cout<<"  "<<names[p]<<(double)iterations/a_numRHS<<" iterations, "<<tSolve<<" s per solve, setup "
+        <<tSetup<<" s, residual "<<worst<<(worst <= 10*tolerance ? "" : " (NOT CONVERGED)")<<endl;
+  }
+}
+
+/**
+ * @brief Multigrid on refinements of the mesh: V-cycles, MG-preconditioned CG and IC0-CG
+ * @details For a mesh-independent method the iteration counts stay flat and the
+ *          time per unknown stays constant as the mesh is refined.
+ */
+static void benchMultigrid(const string& a_prefix) {
+  MeshData coarse;
+  readTextMesh(a_prefix+".node", a_prefix+".elem", coarse);
+  const double tolerance = 1e-8;
+  cout<<"mg: tolerance "<<tolerance<<", 2+2 Gauss-Seidel sweeps, times in s (us per unknown)"<<endl;
+  for(int levels=1; (long)coarse.numElts()<<(2*levels) <= 1L<<20; levels++) {
+    Multigrid mg;
+    auto start = std::chrono::steady_clock::now();
+    mg.setup(coarse, levels, benchCMatrix);
+    double tSetup = secondsSince(start);
+    const CSRMatrix& K = mg.matrix();
+    int n = K.getNumRows();
+    vector<double> b(n, 1.0), x(n, 0.0);
+
+    start = std::chrono::steady_clock::now();
+    int cycles = mg.solve(b.data(), x.data(), tolerance, 200);
+    double tMG = secondsSince(start);
+    double rMG = relativeResidual(K, b, x);
+
+    ConjugateGradient mgcg;
+    mgcg.setup(K, mg);
+    std::fill(x.begin(), x.end(), 0.0);
+    start = std::chrono::steady_clock::now();
+    int mgcgIterations = mgcg.solve(b.data(), x.data(), tolerance, 200);
+    double tMGCG = secondsSince(start);
+    double rMGCG = relativeResidual(K, b, x);
+
+    ConjugateGradient ic;
+    start = std::chrono::steady_clock::now();
+    ic.setup(K, ConjugateGradient::IC0);
+    std::fill(x.begin(), x.end(), 0.0);
+    int icIterations = ic.solve(b.data(), x.data(), tolerance, 10*n+100);
+    double tIC = secondsSince(start);
+    double rIC = relativeResidual(K, b, x);
+
+    double us = 1e6/n;
+    cout<<"  "<<mg.getNumLevels()<<" levels, "<<n<<" unknowns: setup "<<tSetup
+        <<"; V-cycle "<<cycles<<" cycles "<<tMG<<" ("<<tMG*us<<")"
+        <<"; MG-CG "<<mgcgIterations<<" it "<<tMGCG<<" ("<<tMGCG*us<<")"
+        <<"; IC0-CG "<<icIterations<<" it "<<tIC<<" ("<<tIC*us<<")"
+        <<(std::max(rMG, std::max(rMGCG, rIC)) <= 10*tolerance ? "" : " (NOT CONVERGED)")<<endl;
+  }
+}
+
+/**
+ * @brief Dense Cholesky factorization and solve, the O(n^3) reference
+ * @param[in,out] a_A Row-major n x n matrix, replaced by L in its lower triangle
+ * @param[in,out] a_b Right-hand sides, a_numRHS columns of n entries, replaced by the solutions
+ */
+static void denseCholeskySolve(vector<double>& a_A, int a_n, vector<double>& a_b, int a_numRHS) {
+  for(int j=0; j<a_n; j++) {
+    double d = a_A[(size_t)j*a_n+j];
+    for(int p=0; p<j; p++)
+      d -= a_A[(size_t)j*a_n+p]*a_A[(size_t)j*a_n+p];
+    d = sqrt(d);
+    a_A[(size_t)j*a_n+j] = d;
+    for(int i=j+1; i<a_n; i++) {
+      double s = a_A[(size_t)i*a_n+j];
+      for(int p=0; p<j; p++)
+        s -= a_A[(size_t)i*a_n+p]*a_A[(size_t)j*a_n+p];
+      a_A[(size_t)i*a_n+j] = s/d;
+    }
+  }
+  for(int r=0; r<a_numRHS; r++) {
+    double* x = &a_b[(size_t)r*a_n];
+    for(int i=0; i<a_n; i++) {
+      for(int p=0; p<i; p++)
+        x[i] -= a_A[(size_t)i*a_n+p]*x[p];
+      x[i] /= a_A[(size_t)i*a_n+i];
+    }
+    for(int i=a_n-1; i>=0; i--) {
+      for(int p=i+1; p<a_n; p++)
+        x[i] -= a_A[(size_t)p*a_n+i]*x[p];
+      x[i] /= a_A[(size_t)i*a_n+i];
+    }
+  }
+}
+
+/**
+ * @brief Band Cholesky against dense Cholesky and IC(0)-CG for several right-hand sides
+ * @param a_numRHS Number of right-hand sides
+ */
+static void benchBand(const FEGrid& a_grid, int a_numRHS) {
+  CSRMatrix K;
+  assembleRCM(a_grid, K);
+  int n = K.getNumRows();
+  vector<double> b((size_t)n*a_numRHS);
+  for(int r=0; r<a_numRHS; r++)
+    for(int i=0; i<n; i++)
+      b[(size_t)r*n+i] = 1.0 + 0.5*sin(0.37*i + r);
+
+  BandCholesky band;
+  auto start = std::chrono::steady_clock::now();
+  band.factor(K);
+  double tFactor = secondsSince(start);
+  vector<double> x(b);
+  start = std::chrono::steady_clock::now();
+  band.solve(x.data(), a_numRHS);
+  double tSolve = secondsSince(start);
+  double worst = 0;
+  for(int r=0; r<a_numRHS; r++)
+    worst = std::max(worst, relativeResidual(K, vector<double>(b.begin()+(size_t)r*n, b.begin()+(size_t)(r+1)*n),
+                                             vector<double>(x.begin()+(size_t)r*n, x.begin()+(size_t)(r+1)*n)));
+  cout<<"band: "<<n<<" rows, half bandwidth "<<band.getBandwidth()<<", "<<a_numRHS<<" right-hand sides"<<endl;
+  cout<<"  band Cholesky      factor "<<tFactor<<" s, solve "<<tSolve/a_numRHS<<" s per rhs, "
+      <<band.memoryBytes()<<" bytes, residual "<<worst<<endl;
+
+  ConjugateGradient cg;
+  start = std::chrono::steady_clock::now();
+  cg.setup(K, ConjugateGradient::IC0);
+  vector<double> xcg((size_t)n*a_numRHS, 0.0);
+  for(int r=0; r<a_numRHS; r++)
+    cg.solve(&b[(size_t)r*n], &xcg[(size_t)r*n], 1e-10, 10*n+100);
+  double tCG = secondsSince(start);
+  cout<<"  IC0-CG             "<<tCG/a_numRHS<<" s per rhs including setup"<<endl;
+
+  // the dense reference is O(n^3); skip it where it would take minutes
+  if(n <= 4000) {
+    vector<double> A((size_t)n*n, 0.0);
+    for(int i=0; i<n; i++)
+      for(int k=K.rowOffsets()[i]; k<K.rowOffsets()[i+1]; k++)
+        A[(size_t)i*n+K.columns()[k]] = K.values()[k];
+    vector<double> xd(b);
+    start = std::chrono::steady_clock::now();
+    denseCholeskySolve(A, n, xd, a_numRHS);
+    double tDense = secondsSince(start);
+    double maxDiff = 0;
+    for(size_t i=0; i<x.size(); i++)
+      maxDiff = std::max(maxDiff, fabs(x[i]-xd[i]));
+    cout<<"  dense Cholesky     "<<tDense<<" s for all rhs, "<<sizeof(double)*(size_t)n*n
+        <<" bytes, max |band-dense| "<<maxDiff<<endl;
+  }
+  else
+    cout<<"  dense Cholesky     skipped (n > 4000)"<<endl;
+}
+
+/**
+ * @brief Mixed-precision iterative refinement against the same solvers in double
+ * @param a_tolerance Relative residual all solvers must reach
+ * @details Band Cholesky: factor in double and solve, against factor in float
+ *          and refine. CG: Jacobi-CG in double, against Jacobi-CG in float
+ *          inside refinement steps. The matrix is in RCM order for both.
+ */
+static void benchMixedPrecision(const FEGrid& a_grid, double a_tolerance) {
+  CSRMatrix K;
+  assembleRCM(a_grid, K);
+  int n = K.getNumRows();
+  vector<double> b(n);
+  for(int i=0; i<n; i++)
+    b[i] = 1.0 + 0.5*sin(0.37*i);
+  cout<<"mixed: "<<n<<" rows, tolerance "<<a_tolerance<<"; time in s"<<endl;
+
+  BandCholesky band;
+  auto start = std::chrono::steady_clock::now();
+  band.factor(K);
+  double tFactor = secondsSince(start);
+  vector<double> x(b);
+  start = std::chrono::steady_clock::now();
+  band.solve(x.data());
+  double tSolve = secondsSince(start);
+  cout<<"  band double        factor "<<tFactor<<", solve "<<tSolve<<", "<<band.memoryBytes()<<" bytes, residual "
+      <<relativeResidual(K, b, x)<<endl;
+
+  MixedPrecisionSolver mixed;
+  start = std::chrono::steady_clock::now();
+  mixed.setup(K, MixedPrecisionSolver::BAND_CHOLESKY);
+  double tFactorFloat = secondsSince(start);
+  std::fill(x.begin(), x.end(), 0.0);
+  start = std::chrono::steady_clock::now();
+  int steps = mixed.solve(b.data(), x.data(), a_tolerance, 20);
+  double tRefine = secondsSince(start);
+  cout<<"  band float + IR    factor "<<tFactorFloat<<" ("<<tFactor/tFactorFloat<<"x), solve "<<tRefine<<" in "<<steps
+      <<" refinements, "<<mixed.memoryBytes()<<" bytes, residual "<<relativeResidual(K, b, x)
+      <<(mixed.converged() ? "" : " (NOT CONVERGED)")<<endl;
+
+  ConjugateGradient cg;
+  cg.setup(K, ConjugateGradient::JACOBI);
+  std::fill(x.begin(), x.end(), 0.0);
+  start = std::chrono::steady_clock::now();
+  int iterations = cg.solve(b.data(), x.data(), a_tolerance, 10*n+100);
+  double tCG = secondsSince(start);
+  cout<<"  Jacobi-CG double   "<<tCG<<", "<<iterations<<" iterations, residual "<<relativeResidual(K, b, x)<<endl;
+
+  mixed.setup(K, MixedPrecisionSolver::CONJUGATE_GRADIENT);
+  mixed.setInnerTolerance(1e-3, 10*n+100);
+  std::fill(x.begin(), x.end(), 0.0);
+  start = std::chrono::steady_clock::now();
+  steps = mixed.solve(b.data(), x.data(), a_tolerance, 20);
+  double tMixed = secondsSince(start);
+  cout<<"  Jacobi-CG float+IR "<<tMixed<<" ("<<tCG/tMixed<<"x), "<<mixed.getInnerIterations()<<" inner iterations in "
+      <<steps<<" refinements, residual "<<relativeResidual(K, b, x)<<(mixed.converged() ? "" : " (NOT CONVERGED)")<<endl;
+}
+
+/**
+ * @brief Thread counts 1, 2, 4, ... up to and including a_maxThreads
+ */
+static vector<int> threadCounts(int a_maxThreads) {
+  vector<int> counts;
+  for(int t=1; t<a_maxThreads; t*=2)
+    counts.push_back(t);
+  counts.push_back(a_maxThreads);
+  return counts;
+}
+
+/**
+ * @brief max |A_k - B_k| / max |B_k| over the stored values of two matrices with the same pattern
+ */
+static double relativeDifference(const CSRMatrix& a_A, const CSRMatrix& a_B) {
+  double diff = 0, scale = 0;
+  for(int k=0; k<a_B.getNumNonzeros(); k++) {
+    diff = std::max(diff, fabs(a_A.values()[k] - a_B.values()[k]));
+    scale = std::max(scale, fabs(a_B.values()[k]));
+  }
+  return scale > 0 ? diff/scale : diff;
+}
+
+/**
+ * @brief Parallel assembly: serial, colored and per-thread-buffer numeric phases
+ *        for 1, 2, 4, ... up to the maximum number of OpenMP threads
+ */
+static void benchParallelAssemble(const FEGrid& a_grid) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  CSRMatrix K, ref;
+  assembler.symbolic(K);
+  assembler.symbolic(ref);
+  assembler.assemble(ref);
+
+  ElementColoring coloring;
+  auto start = std::chrono::steady_clock::now();
+  coloring.build(a_grid);
+  double tColor = secondsSince(start);
+  cout<<"parallel assemble: "<<coloring.getNumColors()<<" colors (coloring "<<tColor<<" s)"<<endl;
+
+  int maxThreads = 1;
+#ifdef _OPENMP
+  maxThreads = omp_get_max_threads();
+#endif
+  start = std::chrono::steady_clock::now();
+  assembler.assemble(K);
+  double tSerial = secondsSince(start);
+  cout<<"  serial             "<<tSerial<<" s"<<endl;
+  for(int threads : threadCounts(maxThreads)) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    start = std::chrono::steady_clock::now();
+    assembler.assembleColored(K, coloring);
+    double tColored = secondsSince(start);
+    bool same = relativeDifference(K, ref) < 1e-12;
+    start = std::chrono::steady_clock::now();
+    assembler.assembleThreadBuffers(K);
+    double tBuffers = secondsSince(start);
+    same = same && relativeDifference(K, ref) < 1e-12;
+    cout<<"  "<<threads<<" threads: colored "<<tColored<<" s (speedup "<<tSerial/tColored
+        <<"), thread buffers "<<tBuffers<<" s (speedup "<<tSerial/tBuffers<<")"
+        <<(same ? "" : " (MISMATCH)")<<endl;
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(maxThreads);
+#endif
+}
+
+/**
+ * @brief Matrix-free K x (cached element matrices, recomputed from coordinates)
+ *        against assembled CSR SpMV
+ * @param a_repeat Products per timing
+ * @details Bandwidth counts the operator data streamed by one product (CSR
+ *          arrays, or connectivity plus element matrices / coordinates) plus one
+ *          read of x and one write of y.
+ */
+static void benchMatrixFree(const FEGrid& a_grid, int a_repeat) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  CSRMatrix K;
+  assembler.symbolic(K);
+  assembler.assemble(K);
+  ElementColoring coloring;
+  coloring.build(a_grid);
+  int n = K.getNumRows();
+  vector<double> x(n), yRef(n), y(n);
+  for(int i=0; i<n; i++)
+    x[i] = 1.0 + 0.5*sin(0.37*i);
+  K.multiply(x.data(), yRef.data());
+  double yScale = 0;
+  for(int i=0; i<n; i++)
+    yScale = std::max(yScale, fabs(yRef[i]));
+  double vectorBytes = 2.0*sizeof(double)*n;
+  cout<<"matfree: "<<n<<" rows, "<<a_grid.getNumElts()<<" elements, "<<coloring.getNumColors()<<" colors, "
+      <<a_repeat<<" products per timing"<<endl;
+
+  auto start = std::chrono::steady_clock::now();
+  for(int r=0; r<a_repeat; r++)
+    K.multiply(x.data(), y.data());
+  double tCSR = secondsSince(start)/a_repeat;
+  double bytesCSR = K.memoryBytes() + vectorBytes;
+  cout<<"  CSR SpMV           "<<tCSR<<" s, "<<bytesCSR/tCSR*1e-9<<" GB/s, operator "<<K.memoryBytes()<<" bytes"<<endl;
+
+  const char* names[] = {"matrix-free cached ", "matrix-free recomp."};
+  MatrixFreeStiffness::Mode modes[] = {MatrixFreeStiffness::CACHED, MatrixFreeStiffness::RECOMPUTE};
+  for(int m=0; m<2; m++) {
+    MatrixFreeStiffness op;
+    start = std::chrono::steady_clock::now();
+    op.setup(a_grid, assembler, benchCMatrix, coloring, modes[m]);
+    double tSetup = secondsSince(start);
+    op.multiply(x.data(), y.data());
+    double diff = 0;
+    for(int i=0; i<n; i++)
+      diff = std::max(diff, fabs(y[i]-yRef[i]));
+    start = std::chrono::steady_clock::now();
+    for(int r=0; r<a_repeat; r++)
+      op.multiply(x.data(), y.data());
+    double t = secondsSince(start)/a_repeat;
+    double bytes = op.operatorBytes() + vectorBytes;
+    cout<<"  "<<names[m]<<" "<<t<<" s, "<<bytes/t*1e-9<<" GB/s, operator "<<op.operatorBytes()
+        <<" bytes, setup "<<tSetup<<" s, speedup over CSR "<<tCSR/t
+        <<(diff <= 1e-12*yScale ? "" : " (MISMATCH)")<<endl;
+  }
+}
+
+/**
+ * @brief Last-level cache misses of this process, read from the hardware counter
+ *
+ * Uses perf_event_open; where counters are not available (non-Linux, containers,
+ * perf_event_paranoid too high) valid() is false and the benchmarks print n/a.
+ */
+class CacheMissCounter
+{
+public:
+  CacheMissCounter() : m_fd(-1) {
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+    m_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+  ~CacheMissCounter() {
+#ifdef __linux__
+    if(m_fd >= 0)
+      close(m_fd);
+#endif
+  }
+  bool valid() const { return m_fd >= 0; }
+  void start() {
+#ifdef __linux__
+    if(m_fd >= 0) {
+      ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+  /// @return Misses since start(), -1 without a counter
+  long stop() {
+    long count = -1;
+#ifdef __linux__
+    if(m_fd >= 0) {
+      ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+      if(read(m_fd, &count, sizeof(count)) != sizeof(count))
+        count = -1;
+    }
+#endif
+    return count;
+  }
+private:
+  int m_fd;  ///< perf event file descriptor, -1 if unavailable
+};
+
+/**
+ * @brief Element and node orders: file, random, Morton and Hilbert
+ * @param a_grid Grid in file order
+ * @param a_repeat Repetitions per timing
+ * @details For every order: geometry cache build, numeric assembly, CSR K x and
+ *          matrix-free K x, each with time and cache misses per repetition. The
+ *          random order (shuffled elements and nodes) stands for meshes written
+ *          by generators with no locality at all.
+ */
+static void benchSpaceFillingCurve(const FEGrid& a_grid, int a_repeat) {
+  MeshData file;
+  a_grid.getMesh(file);
+  int nn = file.numNodes(), ne = file.numElts();
+
+  MeshData shuffled;
+  {
+    std::mt19937 rng(12345);
+    vector<int> nodeOrder(nn), eltOrder(ne), newNode(nn);
+    for(int i=0; i<nn; i++)
+      nodeOrder[i] = i;
+    for(int i=0; i<ne; i++)
+      eltOrder[i] = i;
+    std::shuffle(nodeOrder.begin(), nodeOrder.end(), rng);
+    std::shuffle(eltOrder.begin(), eltOrder.end(), rng);
+    shuffled.x.resize(nn);
+    shuffled.y.resize(nn);
+    for(int i=0; i<nn; i++) {
+      newNode[nodeOrder[i]] = i;
+      shuffled.x[i] = file.x[nodeOrder[i]];
+      shuffled.y[i] = file.y[nodeOrder[i]];
+    }
+    shuffled.vertices.resize((size_t)ne*VERTICES);
+    for(int i=0; i<ne; i++)
+      for(int k=0; k<VERTICES; k++)
+        shuffled.vertices[(size_t)i*VERTICES+k] = newNode[file.vertices[(size_t)eltOrder[i]*VERTICES+k]];
+  }
+  MeshData morton, hilbert;
+  auto start = std::chrono::steady_clock::now();
+  reorderMesh(file, morton, MORTON);
+  double tMorton = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  reorderMesh(file, hilbert, HILBERT);
+  double tHilbert = secondsSince(start);
+
+  CacheMissCounter counter;
+  cout<<"sfc: "<<nn<<" nodes, "<<ne<<" elements, "<<a_repeat<<" repetitions; Morton "<<tMorton
+      <<" s, Hilbert "<<tHilbert<<" s to reorder; time in s and cache misses per repetition"
+      <<(counter.valid() ? "" : " (no hardware counters: misses n/a)")<<endl;
+  const char* names[] = {"file order", "random    ", "Morton    ", "Hilbert   "};
+  const MeshData* meshes[] = {&file, &shuffled, &morton, &hilbert};
+  double reference = 0;
+  for(int m=0; m<4; m++) {
+    FEGrid grid(*meshes[m]);
+    StiffnessAssembler assembler(grid, benchCMatrix);
+    CSRMatrix K;
+    assembler.symbolic(K);
+    ElementColoring coloring;
+    coloring.build(grid);
+    MatrixFreeStiffness op;
+    int n = K.getNumRows();
+    vector<double> x(n, 1.0), y(n);
+
+    // one timed and counted loop of a_repeat calls of a_work
+    auto measure = [&](auto a_work, double& a_seconds, string& a_misses) {
+      counter.start();
+      auto t0 = std::chrono::steady_clock::now();
+      for(int r=0; r<a_repeat; r++)
+        a_work();
+      a_seconds = secondsSince(t0)/a_repeat;
+      long misses = counter.stop();
+      a_misses = misses >= 0 ? to_string(misses/a_repeat) : "n/a";
+    };
+    double tGeometry, tAssemble, tSpMV, tMatFree;
+    string mGeometry, mAssemble, mSpMV, mMatFree;
+    measure([&]() { grid.buildGeometryCache(); }, tGeometry, mGeometry);
+    measure([&]() { assembler.assemble(K); }, tAssemble, mAssemble);
+    op.setup(grid, assembler, benchCMatrix, coloring, MatrixFreeStiffness::RECOMPUTE);
+    measure([&]() { K.multiply(x.data(), y.data()); }, tSpMV, mSpMV);
+    measure([&]() { op.multiply(x.data(), y.data()); }, tMatFree, mMatFree);
+
+    // the orders permute the same matrix, so sum |K_ij| is invariant
+    double sum = 0;
+    for(double v : K.values())
+      sum += fabs(v);
+    if(m == 0)
+      reference = sum;
+    cout<<"  "<<names[m]<<"  geometry "<<tGeometry<<" ("<<mGeometry<<"), assemble "<<tAssemble<<" ("<<mAssemble
+        <<"), CSR K x "<<tSpMV<<" ("<<mSpMV<<"), matrix-free K x "<<tMatFree<<" ("<<mMatFree<<")"
+        <<(fabs(sum-reference) <= 1e-10*reference ? "" : " (MISMATCH)")<<endl;
+  }
+}
+
+/**
+ * @brief Lanczos extreme eigenvalues of K and of the heat operator M^-1 K
+ * @details For K: lambda_min, lambda_max and the condition number, against the
+ *          Gershgorin bound of lambda_max. For M^-1 K (area-weighted, lumped
+ *          mass): the stable forward Euler step from Lanczos and from the
+ *          element-wise Gershgorin bound of HeatSolver.
+ */
+static void benchSpectrum(const FEGrid& a_grid) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  CSRMatrix K;
+  assembler.symbolic(K);
+  assembler.assemble(K);
+  int n = K.getNumRows();
+  double gershgorin = 0;
+  for(int r=0; r<n; r++) {
+    double sum = 0;
+    for(int k=K.rowOffsets()[r]; k<K.rowOffsets()[r+1]; k++)
+      sum += fabs(K.values()[k]);
+    gershgorin = std::max(gershgorin, sum);
+  }
+  auto start = std::chrono::steady_clock::now();
+  SpectrumEstimate spectrum = lanczosSpectrum(n, [&](const double* a_x, double* a_y) { K.multiply(a_x, a_y); },
+                                              1e-3, 1000, true);
+  double t = secondsSince(start);
+  cout<<"spectrum: "<<n<<" rows"<<endl;
+  cout<<"  K        lambda_min "<<spectrum.lambdaMin<<" +- "<<spectrum.minResidual<<", lambda_max "<<spectrum.lambdaMax
+      <<" +- "<<spectrum.maxResidual<<" (Gershgorin <= "<<gershgorin<<"), condition number "<<spectrum.conditionNumber()
+      <<", "<<spectrum.iterations<<" iterations"<<(spectrum.converged ? "" : " (not converged)")<<", "<<t<<" s"<<endl;
+
+  const double conductivity[DIM*DIM] = {1, 0, 0, 1};
+  HeatSolver heat(a_grid, conductivity, HeatSolver::CSR);
+  start = std::chrono::steady_clock::now();
+  spectrum = heat.estimateSpectrum();
+  t = secondsSince(start);
+  cout<<"  M^-1 K   lambda_max "<<spectrum.lambdaMax<<" +- "<<spectrum.maxResidual<<" (Gershgorin <= "
+      <<heat.eigenvalueBound()<<"), stable dt "<<spectrum.stableTimeStep()<<" (Gershgorin "<<heat.stableTimeStep()
+      <<"), "<<spectrum.iterations<<" iterations, "<<t<<" s"<<endl;
+}
+
+/**
+ * @brief Size of a file in bytes, 0 if it does not exist
+ */
+static long fileBytes(const string& a_fileName) {
+  struct stat st;
+  return stat(a_fileName.c_str(), &st) == 0 ? (long)st.st_size : 0;
+}
+
+/**
+ * @brief Matrix export: dense text (the old DEBUG dump), Matrix Market and binary CSR;
+ *        file size, write time and read time, with a round-trip check
+ */
+static void benchExport(const FEGrid& a_grid) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  CSRMatrix K;
+  assembler.symbolic(K);
+  assembler.assemble(K);
+  int n = K.getNumRows();
+  cout<<"export: "<<n<<" rows, "<<K.getNumNonzeros()<<" nonzeros"<<endl;
+  auto same = [&K](const CSRMatrix& a_A) {
+    return a_A.getNumRows() == K.getNumRows() && a_A.rowOffsets() == K.rowOffsets() &&
+           a_A.columns() == K.columns() && relativeDifference(a_A, K) == 0.0;
+  };
+
+  // the dense dump is O(n^2) bytes; skip it where it would be gigabytes
+  if(n <= 20000) {
+    const string name = "febench_dense.txt";
+    auto start = std::chrono::steady_clock::now();
+    {
+      ofstream out(name);
+      for(int m=0; m<n; m++)
+        for(int c=0; c<n; c++)
+          out<<K(m, c)<<(c != n-1 ? " " : "\n");
+    }
+    double tWrite = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    vector<double> dense((size_t)n*n);
+    {
+      ifstream in(name);
+      for(size_t k=0; k<dense.size(); k++)
+        in>>dense[k];
+    }
+    double tRead = secondsSince(start);
+    cout<<"  dense text         "<<fileBytes(name)<<" bytes, write "<<tWrite<<" s, read "<<tRead<<" s"<<endl;
+    remove(name.c_str());
+  }
+  else
+    cout<<"  dense text         skipped (n > 20000, would be about "<<(double)n*n*2<<" bytes)"<<endl;
+
+  {
+    const string name = "febench.mtx";
+    auto start = std::chrono::steady_clock::now();
+    bool ok = writeMatrixMarket(name, K);
+    double tWrite = secondsSince(start);
+    CSRMatrix A;
+    start = std::chrono::steady_clock::now();
+    readMatrixMarket(name, A);
+    double tRead = secondsSince(start);
+    cout<<"  Matrix Market      "<<fileBytes(name)<<" bytes, write "<<tWrite<<" s, read "<<tRead<<" s"
+        <<(ok && same(A) ? "" : " (MISMATCH)")<<endl;
+    remove(name.c_str());
+  }
+
+  {
+    const string name = "febench.csrbin";
+    auto start = std::chrono::steady_clock::now();
+    bool ok = writeCSRBinary(name, K);
+    double tWrite = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    MappedCSRMatrix mapped(name);
+    double tMap = secondsSince(start);
+    vector<double> x(n, 1.0), y(n), yRef(n);
+    start = std::chrono::steady_clock::now();
+    mapped.multiply(x.data(), y.data());
+    double tFirst = secondsSince(start);
+    CSRMatrix A;
+    start = std::chrono::steady_clock::now();
+    mapped.copyTo(A);
+    double tCopy = secondsSince(start);
+    K.multiply(x.data(), yRef.data());
+    cout<<"  binary CSR         "<<fileBytes(name)<<" bytes, write "<<tWrite<<" s, map "<<tMap
+        <<" s, first K x from the mapping "<<tFirst<<" s, copy to CSRMatrix "<<tCopy<<" s"
+        <<(ok && same(A) && y == yRef ? "" : " (MISMATCH)")<<endl;
+    remove(name.c_str());
+  }
+}
+
+/**
+ * @brief RCB partitions: balance, edge cut and halo, owner-computes assembly and
+ *        K x with halo exchange, one thread per part where threads allow
+ * @param a_repeat Products per timing
+ * @details Efficiency is T(1 part) / (threads x T(P parts)); the work balance
+ *          (average over maximum nonzeros per part) bounds it from above.
+ */
+static void benchPartition(const FEGrid& a_grid, int a_repeat) {
+  StiffnessAssembler assembler(a_grid, benchCMatrix);
+  CSRMatrix K;
+  assembler.symbolic(K);
+  assembler.assemble(K);
+  int n = K.getNumRows();
+  vector<double> x(n), yRef(n), y(n);
+  for(int i=0; i<n; i++)
+    x[i] = 1.0 + 0.5*sin(0.37*i);
+  K.multiply(x.data(), yRef.data());
+  double yScale = 0;
+  for(int i=0; i<n; i++)
+    yScale = std::max(yScale, fabs(yRef[i]));
+  int elementsWithRows = 0;
+
+  int maxThreads = 1;
+#ifdef _OPENMP
+  maxThreads = omp_get_max_threads();
+#endif
+  cout<<"partition: "<<n<<" rows, "<<K.getNumNonzeros()<<" nonzeros, "<<a_repeat<<" products per timing"<<endl;
+  double tAssemble1 = 0, tMultiply1 = 0;
+  for(int parts=1; parts<=std::min(64, n); parts*=2) {
+    int threads = std::min(parts, maxThreads);
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    MeshPartition partition;
+    auto start = std::chrono::steady_clock::now();
+    partition.build(a_grid, assembler, parts);
+    double tBuild = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    partition.assemble(assembler);
+    double tAssemble = secondsSince(start);
+    partition.distribute(x.data());
+    partition.multiply();
+    start = std::chrono::steady_clock::now();
+    for(int r=0; r<a_repeat; r++)
+      partition.multiply();
+    double tMultiply = secondsSince(start)/a_repeat;
+    partition.collect(y.data());
+    double diff = 0;
+    for(int i=0; i<n; i++)
+      diff = std::max(diff, fabs(y[i]-yRef[i]));
+
+    int maxRows = 0, maxElements = 0, maxNonzeros = 0, maxNeighbours = 0;
+    long elements = 0, ghosts = 0, nonzeros = 0;
+    for(int p=0; p<parts; p++) {
+      maxRows = std::max(maxRows, partition.getNumOwned(p));
+      maxElements = std::max(maxElements, partition.getNumElements(p));
+      maxNonzeros = std::max(maxNonzeros, partition.getNumNonzeros(p));
+      maxNeighbours = std::max(maxNeighbours, partition.getNumNeighbours(p));
+      elements += partition.getNumElements(p);
+      ghosts += partition.getNumGhosts(p);
+      nonzeros += partition.getNumNonzeros(p);
+    }
+    if(parts == 1) {
+      elementsWithRows = (int)elements;
+      tAssemble1 = tAssemble;
+      tMultiply1 = tMultiply;
+    }
+    cout<<"  "<<parts<<" parts, "<<threads<<" threads: rows max/avg "<<(double)maxRows*parts/n
+        <<", elements max/avg "<<(double)maxElements*parts/elementsWithRows
+        <<", redundant elements "<<100.0*(elements-elementsWithRows)/elementsWithRows<<"%"
+        <<", edge cut "<<partition.edgeCut()<<", halo "<<ghosts<<" values, max neighbours "<<maxNeighbours<<endl
+        <<"      build "<<tBuild<<" s, assemble "<<tAssemble<<" s (efficiency "<<tAssemble1/(threads*tAssemble)
+        <<"), K x "<<tMultiply<<" s (efficiency "<<tMultiply1/(threads*tMultiply)
+        <<", work balance "<<(double)nonzeros/parts/maxNonzeros<<")"
+        <<(diff <= 1e-12*yScale ? "" : " (MISMATCH)")<<endl;
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(maxThreads);
+#endif
+}
+
+/**
+ * @brief One step of the Part II solver as it was: Simulate copied the values
+ *        for the error, Update copy-constructed a temporary and assigned it back
+ */
+static void legacyStencilStep(vector<double>& a_values, vector<double>& a_previous, double a_r) {
+  a_previous = a_values;
+  vector<double> newValues = a_values;
+  for(size_t i=1; i<a_values.size()-1; i++)
+    newValues[i] = a_values[i] + a_r*(a_values[i-1] - 2*a_values[i] + a_values[i+1]);
+  a_values = newValues;
+}
+
+/**
+ * @brief The separate error pass Simulate made after each update
+ * @return Max |a_values[i] - a_previous[i]|
+ */
+static double maxChange(const vector<double>& a_values, const vector<double>& a_previous) {
+  double change = 0;
+  for(size_t i=0; i<a_values.size(); i++)
+    change = std::max(change, fabs(a_values[i] - a_previous[i]));
+  return change;
+}
+
+/**
+ * @brief Part II time stepping with the convergence measure, from the copying
+ *        step to the fused, double-buffered GridFn::UpdateWithChange
+ * @param a_maxPoints Largest grid, grids go from 10^3 points up by factors of 10
+ * @details Mesh independent. Steps are repeated so each timing covers about
+ *          10^8 point updates. Bytes per step count the doubles each variant
+ *          reads and writes per point: the copying step 80 (two copies, the
+ *          stencil, the assignment back, the error pass), the double-buffered
+ *          update 16 plus 16 for the error pass, the fused update 16. Write
+ *          allocation of the output lines comes on top of this.
+ */
+static void benchStencil(long a_maxPoints) {
+  cout<<"stencil: explicit 1D heat steps with max |du|, steps/s"<<endl;
+  for(long n=1000; n<=a_maxPoints; n*=10) {
+    double dx = 1.0/n, dt = 0.4*dx*dx;
+    int steps = (int)std::max(10L, 100000000L/n);
+    vector<double> values = GridFn(1.0, dx).GetValues();
+    double points = (double)values.size();
+
+    vector<double> previous;
+    double legacyChange = 0;
+    long allocs = allocationCount();
+    auto start = std::chrono::steady_clock::now();
+    for(int s=0; s<steps; s++) {
+      legacyStencilStep(values, previous, dt/(dx*dx));
+      legacyChange = maxChange(values, previous);
+    }
+    double tLegacy = secondsSince(start);
+    long legacyAllocs = allocationCount() - allocs;
+    vector<double>().swap(previous);
+    cout<<"  "<<(long)points<<" points x "<<steps<<" steps"<<endl;
+
+    auto report = [&](const char* a_name, double a_seconds, double a_bytesPerPoint, long a_allocs,
+                      const GridFn* a_grid, double a_change) {
+      double diff = 0;
+      if(a_grid)
+        for(size_t i=0; i<values.size(); i++)
+          diff = std::max(diff, fabs(values[i] - a_grid->GetValues()[i]));
+      cout<<"    "<<a_name<<" "<<steps/a_seconds<<" steps/s, "<<a_bytesPerPoint*points/1e6<<" MB/step, "
+          <<a_bytesPerPoint*points*steps/a_seconds/1e9<<" GB/s, "<<(double)a_allocs/steps<<" allocations/step, speedup "
+          <<tLegacy/a_seconds<<", max difference "<<diff<<", error difference "<<fabs(a_change - legacyChange)<<endl;
+    };
+    report("copying + error pass        ", tLegacy, 80, legacyAllocs, nullptr, legacyChange);
+
+    {
+      GridFn grid(1.0, dx);
+      double change = 0;
+      allocs = allocationCount();
+      start = std::chrono::steady_clock::now();
+      for(int s=0; s<steps; s++) {
+        grid.Update(1.0, dt);
+        change = maxChange(grid.GetValues(), grid.GetPreviousValues());
+      }
+      double t = secondsSince(start);
+      report("double-buffered + error pass", t, 32, allocationCount() - allocs, &grid, change);
+    }
+    {
+      GridFn grid(1.0, dx);
+      double change = 0;
+      allocs = allocationCount();
+      start = std::chrono::steady_clock::now();
+      for(int s=0; s<steps; s++)
+        change = grid.UpdateWithChange(1.0, dt);
+      double t = secondsSince(start);
+      report("fused update and error      ", t, 16, allocationCount() - allocs, &grid, change);
+    }
+    {
+      GridFn grid(1.0, dx);
+      double change = 0;
+      allocs = allocationCount();
+      start = std::chrono::steady_clock::now();
+      for(int s=1; s<=steps; s++) {
+        if(s % 10 == 0)
+          change = grid.UpdateWithChange(1.0, dt);
+        else
+          grid.Update(1.0, dt);
+      }
+      double t = secondsSince(start);
+      report("fused, error every 10 steps ", t, 16, allocationCount() - allocs, &grid, change);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if(argc < 2)
+    {
+      cout << "usage: " << argv[0] << " <prefix of .node/.elem files> [load|topology|geometry|kernel|assemble|dump|rcm|cg|band|mg|parallel|partition|export|matfree|sfc|spectrum|mixed|stencil]" << endl;
+      cout << "       " << argv[0] << " stencil [max points]" << endl;
+      return 1;
+    }
+  string prefix(argv[1]);
+
+  // The 1D stencil needs no mesh
+  if(prefix == "stencil")
+    {
+      long maxPoints = (argc > 2) ? atol(argv[2]) : 100000000L;
+      if(maxPoints < 1000)
+        {
+          cout << "max points must be at least 1000" << endl;
+          return 1;
+        }
+      benchStencil(maxPoints);
+      return 0;
+    }
+  string section = (argc > 2) ? argv[2] : "all";
+
+  if(section == "all" || section == "load")
+    benchLoad(prefix);
+
+  FEGrid grid(prefix+".node", prefix+".elem");
+  if(section == "all" || section == "topology")
+    benchTopology(grid);
+  // Repeat sweeps on small meshes so each timing covers about 10^7 elements
+  int repeat = std::max(1, 10000000/std::max(1, grid.getNumElts()));
+  if(section == "all" || section == "geometry")
+    benchGeometry(grid, repeat);
+  if(section == "all" || section == "kernel")
+    benchKernel(grid, std::max(1, repeat/10));
+  if(section == "all" || section == "assemble")
+    benchAssemble(grid);
+  if(section == "all" || section == "dump")
+    benchDump(grid, std::max(1, repeat/100));
+  if(section == "all" || section == "rcm")
+    benchRCM(grid, repeat);
+  if(section == "all" || section == "cg")
+    benchCG(grid, 20);
+  if(section == "all" || section == "band")
+    benchBand(grid, 20);
+  if(section == "all" || section == "mg")
+    benchMultigrid(prefix);
+  if(section == "all" || section == "parallel")
+    benchParallelAssemble(grid);
+  if(section == "all" || section == "partition")
+    benchPartition(grid, std::max(1, repeat/10));
+  if(section == "all" || section == "export")
+    benchExport(grid);
+  if(section == "all" || section == "matfree")
+    benchMatrixFree(grid, std::max(1, repeat/10));
+  if(section == "all" || section == "sfc")
+    benchSpaceFillingCurve(grid, std::max(5, repeat/100));
+  if(section == "all" || section == "spectrum")
+    benchSpectrum(grid);
+  if(section == "all" || section == "mixed")
+    benchMixedPrecision(grid, 1e-10);
+  // 10^8 points need 2.4 GB for the copying steps; only on request
+  if(section == "all" || section == "stencil")
+    benchStencil(section == "stencil" ? 100000000L : 1000000L);
+  return 0;
+}
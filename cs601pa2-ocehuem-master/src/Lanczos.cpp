@@ -0,0 +1,172 @@
+/**
+ * @file Lanczos.cpp
+ * @brief Implementation of the Lanczos extreme eigenvalue estimator
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Lanczos.h"
+
+namespace {
+
+/// Seed of the start vector
+const unsigned LANCZOS_SEED = 20240601u;
+
+/// Number of eigenvalues below a_x of the tridiagonal matrix (a_alpha, a_beta) of order a_k (Sturm count)
+int eigenvaluesBelow(const std::vector<double>& a_alpha, const std::vector<double>& a_beta, int a_k, double a_x) {
+  int count = 0;
+  double d = 1.0;
+  for (int i = 0; i < a_k; i++) {
+    double coupling = i > 0 ? a_beta[i - 1] * a_beta[i - 1] / d : 0.0;
+    d = a_alpha[i] - a_x - coupling;
+    if (d == 0.0)
+      d = -1e-300;
+    if (d < 0.0)
+      count++;
+  }
+  return count;
+}
+
+/**
+ * @brief Smallest (a_index 0) or largest (a_index a_k-1) eigenvalue of a tridiagonal matrix by bisection
+ * @param a_alpha Diagonal
+ * @param a_beta Off-diagonal
+ * @param a_k Order
+ * @param a_index Which eigenvalue, counted from the smallest
+ * @return Eigenvalue to about machine precision
+ */
+double tridiagonalEigenvalue(const std::vector<double>& a_alpha, const std::vector<double>& a_beta, int a_k,
+                             int a_index) {
+  // Gershgorin interval
+  double lo = a_alpha[0], hi = a_alpha[0];
+  for (int i = 0; i < a_k; i++) {
+    double r = (i > 0 ? std::fabs(a_beta[i - 1]) : 0.0) + (i + 1 < a_k ? std::fabs(a_beta[i]) : 0.0);
+    lo = std::min(lo, a_alpha[i] - r);
+    hi = std::max(hi, a_alpha[i] + r);
+  }
+  for (int it = 0; it < 200 && hi - lo > 1e-15 * std::max(std::fabs(lo), std::fabs(hi)); it++) {
+    double mid = 0.5 * (lo + hi);
+    if (eigenvaluesBelow(a_alpha, a_beta, a_k, mid) > a_index)
+      hi = mid;
+    else
+      lo = mid;
+  }
+  return 0.5 * (lo + hi);
+}
+
+/**
+ * @brief Last entry of the normalized eigenvector of an extreme eigenvalue, by inverse iteration
+ * @param a_alpha Diagonal
+ * @param a_beta Off-diagonal
+ * @param a_k Order
+ * @param a_theta Smallest or largest eigenvalue
+ * @param a_largest Whether a_theta is the largest
+ * @param a_scale Magnitude of the spectrum
+ * @return |s_k|
+ * @details The shift is moved just outside the spectrum, so T - shift I is
+ *          definite and the tridiagonal solve needs no pivoting.
+ */
+double lastEigenvectorEntry(const std::vector<double>& a_alpha, const std::vector<double>& a_beta, int a_k,
+                            double a_theta, bool a_largest, double a_scale) {
+  double shift = a_theta + (a_largest ? 1.0 : -1.0) * 1e-10 * a_scale;
+  std::vector<double> x(a_k, 1.0), c(a_k), d(a_k);
+  for (int it = 0; it < 3; it++) {
+    // Thomas algorithm on (T - shift I) y = x
+    double piv = a_alpha[0] - shift;
+    c[0] = a_k > 1 ? a_beta[0] / piv : 0.0;
+    d[0] = x[0] / piv;
+    for (int i = 1; i < a_k; i++) {
+      piv = a_alpha[i] - shift - a_beta[i - 1] * c[i - 1];
+      c[i] = i + 1 < a_k ? a_beta[i] / piv : 0.0;
+      d[i] = (x[i] - a_beta[i - 1] * d[i - 1]) / piv;
+    }
+    x[a_k - 1] = d[a_k - 1];
+    for (int i = a_k - 2; i >= 0; i--)
+      x[i] = d[i] - c[i] * x[i + 1];
+    double norm = 0.0;
+    for (double xi : x)
+      norm += xi * xi;
+    norm = 1.0 / std::sqrt(norm);
+    for (double& xi : x)
+      xi *= norm;
+  }
+  return std::fabs(x[a_k - 1]);
+}
+
+} // namespace
+
+/**
+ * @brief Lanczos recurrence with Ritz values of the tridiagonal matrix after every step
+ * @details The residual norm of Ritz pair (theta, T s) is beta_k |s_k|, with
+ *          beta_k the last off-diagonal and s_k the last entry of the
+ *          normalized eigenvector s of the k x k tridiagonal matrix T. Only the
+ *          extreme Ritz pairs are needed, so they come from Sturm bisection and
+ *          inverse iteration in O(k) per step rather than from a full
+ *          eigen-decomposition of T.
+ */
+SpectrumEstimate lanczosSpectrum(int a_n, const SymmetricOperator& a_apply, double a_tolerance,
+                                 int a_maxIterations, bool a_wantMin) {
+  SpectrumEstimate estimate;
+  if (a_n <= 0)
+    return estimate;
+  std::vector<double> vPrev(a_n, 0.0), v(a_n), w(a_n);
+  std::mt19937 generator(LANCZOS_SEED);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  for (int i = 0; i < a_n; i++)
+    v[i] = uniform(generator);
+  double norm = 0.0;
+  for (int i = 0; i < a_n; i++)
+    norm += v[i] * v[i];
+  norm = 1.0 / std::sqrt(norm);
+  for (int i = 0; i < a_n; i++)
+    v[i] *= norm;
+
+  std::vector<double> alpha, beta;
+  int maxIterations = std::min(a_maxIterations, a_n);
+  double betaPrev = 0.0;
+  for (int j = 0; j < maxIterations; j++) {
+    a_apply(v.data(), w.data());
+    double a = 0.0;
+    double* wp = w.data();
+    const double* vp = v.data();
+    const double* vq = vPrev.data();
+#pragma omp parallel for simd reduction(+:a) schedule(static)
+    for (int i = 0; i < a_n; i++)
+      a += wp[i] * vp[i];
+    double b = 0.0;
+#pragma omp parallel for simd reduction(+:b) schedule(static)
+    for (int i = 0; i < a_n; i++) {
+      wp[i] -= a * vp[i] + betaPrev * vq[i];
+      b += wp[i] * wp[i];
+    }
+    b = std::sqrt(b);
+    alpha.push_back(a);
+    beta.push_back(b);
+
+    int k = j + 1;
+    estimate.lambdaMin = tridiagonalEigenvalue(alpha, beta, k, 0);
+    estimate.lambdaMax = tridiagonalEigenvalue(alpha, beta, k, k - 1);
+    double scale = std::max(std::fabs(estimate.lambdaMax), std::fabs(estimate.lambdaMin));
+    estimate.minResidual = b * lastEigenvectorEntry(alpha, beta, k, estimate.lambdaMin, false, scale);
+    estimate.maxResidual = b * lastEigenvectorEntry(alpha, beta, k, estimate.lambdaMax, true, scale);
+    estimate.iterations = k;
+
+    bool maxDone = estimate.maxResidual <= a_tolerance * std::fabs(estimate.lambdaMax);
+    bool minDone = estimate.minResidual <= a_tolerance * std::fabs(estimate.lambdaMin);
+    // b = 0: the Krylov space is invariant and the Ritz values are exact
+    if (b <= 1e-14 * scale || (maxDone && (!a_wantMin || minDone))) {
+      estimate.converged = true;
+      break;
+    }
+    double invB = 1.0 / b;
+    vPrev.swap(v);
+    double* vn = v.data();
+#pragma omp parallel for simd schedule(static)
+    for (int i = 0; i < a_n; i++)
+      vn[i] = wp[i] * invB;
+    betaPrev = b;
+  }
+  return estimate;
+}
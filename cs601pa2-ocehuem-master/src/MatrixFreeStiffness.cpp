@@ -0,0 +1,182 @@
+/**
+ * @file MatrixFreeStiffness.cpp
+ * @brief Implementation of the matrix-free stiffness operator
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "MatrixFreeStiffness.h"
+
+/**
+ * @brief Default constructor
+ */
+MatrixFreeStiffness::MatrixFreeStiffness() : m_grid(nullptr), m_mode(CACHED), m_areaWeighted(false), m_c{0.0, 0.0, 0.0} { }
+
+/**
+ * @brief Copy the connectivity into color order and build the element matrices
+ * @param a_grid Grid
+ * @param a_assembler Assembler defining the rows
+ * @param a_cMatrix Material matrix
+ * @param a_coloring Element coloring
+ * @param a_mode Mode
+ * @param a_areaWeighted Scale by the element area
+ * @details Element matrices are K_ab = g_a^T C g_b with the shape function
+ *          gradients g of FEGrid::gradient(), i.e. the unmasked
+ *          StiffnessAssembler::elementMatrix().
+ */
+void MatrixFreeStiffness::setup(const FEGrid& a_grid, const StiffnessAssembler& a_assembler,
+                                const double a_cMatrix[DIM*DIM], const ElementColoring& a_coloring, Mode a_mode, bool a_areaWeighted) {
+  if (a_cMatrix[1] != a_cMatrix[2])
+    throw std::invalid_argument("MatrixFreeStiffness needs a symmetric C");
+  m_grid = &a_grid;
+  m_mode = a_mode;
+  m_areaWeighted = a_areaWeighted;
+  m_c[0] = a_cMatrix[0];
+  m_c[1] = a_cMatrix[1];
+  m_c[2] = a_cMatrix[3];
+  m_colorOffsets = a_coloring.colorOffsets();
+  const std::vector<int>& elts = a_coloring.elts();
+  int ne = (int)elts.size();
+  for (int k = 0; k < VERTICES; k++)
+    {
+      const int* v = a_grid.vertexArray(k);
+      m_v[k].resize(ne);
+      for (int i = 0; i < ne; i++)
+        m_v[k][i] = v[elts[i]];
+    }
+  for (int k = 0; k < 6; k++)
+    m_k[k].clear();
+  if (a_mode == CACHED)
+    {
+      for (int k = 0; k < 6; k++)
+        m_k[k].resize(ne);
+      const int pairs[6][2] = {{0, 0}, {0, 1}, {0, 2}, {1, 1}, {1, 2}, {2, 2}};
+#pragma omp parallel for schedule(static)
+      for (int i = 0; i < ne; i++)
+        {
+          double g[VERTICES][DIM];
+          for (int m = 0; m < VERTICES; m++)
+            a_grid.gradient(g[m], elts[i], m);
+          double scale = a_areaWeighted ? a_grid.elementArea(elts[i]) : 1.0;
+          for (int k = 0; k < 6; k++)
+            {
+              const double* a = g[pairs[k][0]];
+              const double* b = g[pairs[k][1]];
+              m_k[k][i] = scale*(m_c[0]*a[0]*b[0] + m_c[1]*(a[0]*b[1] + a[1]*b[0]) + m_c[2]*a[1]*b[1]);
+            }
+        }
+    }
+  m_rowNode = a_assembler.rowNode();
+  m_xNode.assign(a_grid.getNumNodes(), 0.0);
+  m_yNode.assign(a_grid.getNumNodes(), 0.0);
+}
+
+/**
+ * @brief Cached element matrices times gathered nodal values, one element per lane
+ * @param a_begin First element (in color order) of the color
+ * @param a_end One past the last element of the color
+ */
+void MatrixFreeStiffness::applyCached(int a_begin, int a_end) const {
+  const int* v0 = m_v[0].data();
+  const int* v1 = m_v[1].data();
+  const int* v2 = m_v[2].data();
+  const double* k00 = m_k[0].data();
+  const double* k01 = m_k[1].data();
+  const double* k02 = m_k[2].data();
+  const double* k11 = m_k[3].data();
+  const double* k12 = m_k[4].data();
+  const double* k22 = m_k[5].data();
+  const double* x = m_xNode.data();
+  double* y = m_yNode.data();
+#pragma omp parallel for simd schedule(static)
+  for (int i = a_begin; i < a_end; i++)
+    {
+      double x0 = x[v0[i]], x1 = x[v1[i]], x2 = x[v2[i]];
+      y[v0[i]] += k00[i]*x0 + k01[i]*x1 + k02[i]*x2;
+      y[v1[i]] += k01[i]*x0 + k11[i]*x1 + k12[i]*x2;
+      y[v2[i]] += k02[i]*x0 + k12[i]*x1 + k22[i]*x2;
+    }
+}
+
+/**
+ * @brief Element matrices rebuilt from the coordinates, one element per lane
+ * @param a_begin First element (in color order) of the color
+ * @param a_end One past the last element of the color
+ * @details Gradients as in FEGrid::gradients(); K x is then C applied to the
+ *          element gradient of x, projected back on the three gradients.
+ */
+void MatrixFreeStiffness::applyRecompute(int a_begin, int a_end) const {
+  const int* v0 = m_v[0].data();
+  const int* v1 = m_v[1].data();
+  const int* v2 = m_v[2].data();
+  const double* xc = m_grid->xCoords();
+  const double* yc = m_grid->yCoords();
+  const double c00 = m_c[0], c01 = m_c[1], c11 = m_c[2];
+  const bool areaWeighted = m_areaWeighted;
+  const double* x = m_xNode.data();
+  double* y = m_yNode.data();
+#pragma omp parallel for simd schedule(static)
+  for (int i = a_begin; i < a_end; i++)
+    {
+      double px0 = xc[v0[i]], py0 = yc[v0[i]];
+      double px1 = xc[v1[i]], py1 = yc[v1[i]];
+      double px2 = xc[v2[i]], py2 = yc[v2[i]];
+      double det = (px1 - px0)*(py2 - py0) - (px2 - px0)*(py1 - py0);
+      double invDet = 1.0/det;
+      double scale = areaWeighted ? 0.5*std::fabs(det) : 1.0;
+      double gx0 = (py1 - py2)*invDet, gy0 = (px2 - px1)*invDet;
+      double gx1 = (py2 - py0)*invDet, gy1 = (px0 - px2)*invDet;
+      double gx2 = (py0 - py1)*invDet, gy2 = (px1 - px0)*invDet;
+      double x0 = x[v0[i]], x1 = x[v1[i]], x2 = x[v2[i]];
+      // gradient of x on the element, then C (and the area) times it
+      double ux = gx0*x0 + gx1*x1 + gx2*x2;
+      double uy = gy0*x0 + gy1*x1 + gy2*x2;
+      double fx = scale*(c00*ux + c01*uy);
+      double fy = scale*(c01*ux + c11*uy);
+      y[v0[i]] += gx0*fx + gy0*fy;
+      y[v1[i]] += gx1*fx + gy1*fy;
+      y[v2[i]] += gx2*fx + gy2*fy;
+    }
+}
+
+/**
+ * @brief Scatter x to nodes, run the colors in turn, gather y
+ * @param a_x Input vector
+ * @param[out] a_y Output vector
+ */
+void MatrixFreeStiffness::multiply(const double* a_x, double* a_y) const {
+  int n = getNumRows();
+  const int* rowNode = m_rowNode.data();
+  double* xNode = m_xNode.data();
+  std::fill(m_yNode.begin(), m_yNode.end(), 0.0);
+#pragma omp parallel for schedule(static)
+  for (int r = 0; r < n; r++)
+    xNode[rowNode[r]] = a_x[r];
+  for (size_t c = 0; c + 1 < m_colorOffsets.size(); c++)
+    {
+      if (m_mode == CACHED)
+        applyCached(m_colorOffsets[c], m_colorOffsets[c + 1]);
+      else
+        applyRecompute(m_colorOffsets[c], m_colorOffsets[c + 1]);
+    }
+  const double* yNode = m_yNode.data();
+#pragma omp parallel for schedule(static)
+  for (int r = 0; r < n; r++)
+    a_y[r] = yNode[rowNode[r]];
+}
+
+/**
+ * @brief Per-element bytes streamed by one application
+ * @return Connectivity plus, for CACHED, the element matrices or, for
+ *         RECOMPUTE, the node coordinates
+ */
+size_t MatrixFreeStiffness::operatorBytes() const {
+  size_t ne = m_v[0].size();
+  size_t bytes = VERTICES * sizeof(int) * ne;
+  if (m_mode == CACHED)
+    bytes += 6 * sizeof(double) * ne;
+  else
+    bytes += 2 * sizeof(double) * m_xNode.size();
+  return bytes;
+}
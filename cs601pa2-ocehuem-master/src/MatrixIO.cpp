@@ -0,0 +1,245 @@
+/**
+ * @file MatrixIO.cpp
+ * @brief Implementation of the Matrix Market and binary CSR matrix files
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "TextIO.h"
+#include "MatrixIO.h"
+
+/**
+ * @brief Write the banner, the size line and one "i j value" line per entry
+ * @details Rows are formatted in parallel batches by writeLinesParallel; the
+ *          entry count is known up front from the row offsets and columns.
+ */
+bool writeMatrixMarket(const std::string& a_fileName, const CSRMatrix& a_K, bool a_symmetric) {
+  const int* offsets = a_K.rowOffsets().data();
+  const int* cols = a_K.columns().data();
+  const double* vals = a_K.values().data();
+  int n = a_K.getNumRows();
+  long count = a_K.getNumNonzeros();
+  if (a_symmetric) {
+    count = 0;
+    for (int i = 0; i < n; i++)
+      for (int k = offsets[i]; k < offsets[i + 1] && cols[k] <= i; k++)
+        count++;
+  }
+
+  FILE* fp = fopen(a_fileName.c_str(), "w");
+  if (!fp)
+    return false;
+  bool ok = fprintf(fp, "%%%%MatrixMarket matrix coordinate real %s\n%d %d %ld\n",
+                    a_symmetric ? "symmetric" : "general", n, n, count) > 0;
+  ok = ok && writeLinesParallel(fp, n, [=](size_t i, std::string& line) {
+      for (int k = offsets[i]; k < offsets[i + 1]; k++) {
+        if (a_symmetric && cols[k] > (int)i)
+          break;
+        appendField(line, (long)i + 1, ' ');
+        appendField(line, cols[k] + 1, ' ');
+        appendField(line, vals[k], '\n');
+      }
+    });
+  ok = (fclose(fp) == 0) && ok;
+  return ok;
+}
+
+/**
+ * @brief Parse a Matrix Market file into CSR
+ * @details Entries are counted per row (both triangles for "symmetric"), placed
+ *          by a prefix sum, then every row is sorted and duplicates are summed.
+ */
+void readMatrixMarket(const std::string& a_fileName, CSRMatrix& a_K) {
+  MappedFile file(a_fileName);
+  const char* p = file.data();
+  const char* end = p + file.size();
+  const char* line = p;
+  p = nextLine(p, end);
+  std::string banner(line, p);
+  if (banner.compare(0, 14, "%%MatrixMarket") != 0 || banner.find("coordinate") == std::string::npos ||
+      banner.find("real") == std::string::npos)
+    throw std::runtime_error("Not a real coordinate Matrix Market file: " + a_fileName);
+  bool symmetric = banner.find("symmetric") != std::string::npos;
+  while (p < end && *skipBlanks(p, end) == '%')
+    p = nextLine(p, end);
+
+  long rows, columns, count;
+  if (!(p = parseField(p, end, rows)) || !(p = parseField(p, end, columns)) || !(p = parseField(p, end, count)) ||
+      rows != columns || rows < 0 || count < 0)
+    throw std::runtime_error("Bad size line in " + a_fileName);
+  int n = (int)rows;
+  std::vector<int> entryRow(count), entryColumn(count);
+  std::vector<double> entryValue(count);
+  for (long e = 0; e < count; e++) {
+    long i, j;
+    p = nextLine(p, end);
+    if (!(p = parseField(p, end, i)) || !(p = parseField(p, end, j)) || !(p = parseField(p, end, entryValue[e])) ||
+        i < 1 || i > n || j < 1 || j > n)
+      throw std::runtime_error("Malformed entry in " + a_fileName);
+    entryRow[e] = (int)i - 1;
+    entryColumn[e] = (int)j - 1;
+  }
+
+  std::vector<int> offsets(n + 1, 0);
+  for (long e = 0; e < count; e++) {
+    offsets[entryRow[e] + 1]++;
+    if (symmetric && entryRow[e] != entryColumn[e])
+      offsets[entryColumn[e] + 1]++;
+  }
+  for (int i = 0; i < n; i++)
+    offsets[i + 1] += offsets[i];
+  std::vector<std::pair<int, double> > entries(offsets[n]);
+  std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+  for (long e = 0; e < count; e++) {
+    entries[fill[entryRow[e]]++] = std::make_pair(entryColumn[e], entryValue[e]);
+    if (symmetric && entryRow[e] != entryColumn[e])
+      entries[fill[entryColumn[e]]++] = std::make_pair(entryRow[e], entryValue[e]);
+  }
+
+  std::vector<int> rowOffsets(n + 1, 0), cols;
+  std::vector<double> vals;
+  cols.reserve(entries.size());
+  vals.reserve(entries.size());
+  for (int i = 0; i < n; i++) {
+    std::sort(entries.begin() + offsets[i], entries.begin() + offsets[i + 1],
+              [](const std::pair<int, double>& a, const std::pair<int, double>& b) { return a.first < b.first; });
+    for (int k = offsets[i]; k < offsets[i + 1]; k++) {
+      if (k > offsets[i] && entries[k].first == entries[k - 1].first)
+        vals.back() += entries[k].second;
+      else {
+        cols.push_back(entries[k].first);
+        vals.push_back(entries[k].second);
+      }
+    }
+    rowOffsets[i + 1] = (int)cols.size();
+  }
+  a_K.setPattern(n, rowOffsets, cols);
+  std::copy(vals.begin(), vals.end(), a_K.values().begin());
+}
+
+/**
+ * @brief Write the header and 64-byte aligned arrays of a .csrbin file
+ */
+bool writeCSRBinary(const std::string& a_fileName, const CSRMatrix& a_K) {
+  CSRBinaryHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, "CSRBIN", 6);
+  h.version = CSRBIN_VERSION;
+  h.numRows = a_K.getNumRows();
+  h.numNonzeros = a_K.getNumNonzeros();
+  h.offsetsOffset = align64(sizeof(h));
+  h.columnsOffset = align64(h.offsetsOffset + sizeof(int) * (h.numRows + 1));
+  h.valuesOffset = align64(h.columnsOffset + sizeof(int) * h.numNonzeros);
+  uint64_t total = h.valuesOffset + sizeof(double) * h.numNonzeros;
+
+  // Write to a temporary name and rename, so a reader never maps a partial file
+  std::string tmpName = a_fileName + ".tmp";
+  FILE* fp = fopen(tmpName.c_str(), "wb");
+  if (!fp)
+    return false;
+  static const char zeros[64] = {0};
+  bool ok = true;
+  auto writeAt = [&](uint64_t a_offset, const void* a_data, size_t a_bytes) {
+    long pos = ftell(fp);
+    if (pos >= 0 && (uint64_t)pos < a_offset)
+      ok = ok && fwrite(zeros, 1, a_offset - pos, fp) == a_offset - pos;
+    if (a_bytes > 0)
+      ok = ok && fwrite(a_data, 1, a_bytes, fp) == a_bytes;
+  };
+  std::vector<int> rowOffsets(a_K.rowOffsets());
+  rowOffsets.resize(h.numRows + 1, 0);
+  writeAt(0, &h, sizeof(h));
+  writeAt(h.offsetsOffset, rowOffsets.data(), sizeof(int) * (h.numRows + 1));
+  writeAt(h.columnsOffset, a_K.columns().data(), sizeof(int) * h.numNonzeros);
+  writeAt(h.valuesOffset, a_K.values().data(), sizeof(double) * h.numNonzeros);
+  ok = ok && (uint64_t)ftell(fp) == total;
+  ok = (fclose(fp) == 0) && ok;
+  if (ok)
+    ok = rename(tmpName.c_str(), a_fileName.c_str()) == 0;
+  if (!ok)
+    remove(tmpName.c_str());
+  return ok;
+}
+
+/**
+ * @brief Map a .csrbin file and point the arrays into it
+ * @param a_fileName Path of the file
+ */
+MappedCSRMatrix::MappedCSRMatrix(const std::string& a_fileName)
+  : m_file(new MappedFile(a_fileName)), m_numRows(0), m_numNonzeros(0),
+    m_rowOffsets(nullptr), m_columns(nullptr), m_values(nullptr) {
+  CSRBinaryHeader h;
+  uint64_t size = m_file->size();
+  if (size < sizeof(h))
+    throw std::runtime_error("Truncated matrix file " + a_fileName);
+  memcpy(&h, m_file->data(), sizeof(h));
+  if (memcmp(h.magic, "CSRBIN", 6) != 0 || h.version != CSRBIN_VERSION)
+    throw std::runtime_error("Not a version " + std::to_string(CSRBIN_VERSION) + " .csrbin file: " + a_fileName);
+  if (h.numRows < 0 || h.numNonzeros < 0 || h.numRows >= INT_MAX || h.numNonzeros > INT_MAX)
+    throw std::runtime_error("Corrupt header in matrix file " + a_fileName);
+  // Each array 64-byte aligned, after the header and inside the file
+  auto inside = [&](uint64_t a_offset, uint64_t a_bytes) {
+    return a_offset % 64 == 0 && a_offset >= sizeof(h) && a_offset <= size && a_bytes <= size - a_offset;
+  };
+  if (!inside(h.offsetsOffset, sizeof(int) * (uint64_t)(h.numRows + 1)) ||
+      !inside(h.columnsOffset, sizeof(int) * (uint64_t)h.numNonzeros) ||
+      !inside(h.valuesOffset, sizeof(double) * (uint64_t)h.numNonzeros))
+    throw std::runtime_error("Truncated or corrupt matrix file " + a_fileName);
+
+  const char* base = m_file->data();
+  int n = (int)h.numRows;
+  int nnz = (int)h.numNonzeros;
+  const int* offsets = reinterpret_cast<const int*>(base + h.offsetsOffset);
+  const int* cols = reinterpret_cast<const int*>(base + h.columnsOffset);
+  // Row offsets from 0 to nnz without decreasing, and columns in range, so
+  // multiply() and copyTo() stay inside the mapping
+  bool ok = offsets[0] == 0 && offsets[n] == nnz;
+#pragma omp parallel for reduction(&&:ok) schedule(static)
+  for (int i = 0; i < n; i++)
+    ok = ok && offsets[i] <= offsets[i + 1];
+#pragma omp parallel for simd reduction(&&:ok) schedule(static)
+  for (int k = 0; k < nnz; k++)
+    ok = ok && cols[k] >= 0 && cols[k] < n;
+  if (!ok)
+    throw std::runtime_error("Corrupt row offsets or columns in matrix file " + a_fileName);
+  m_numRows = n;
+  m_numNonzeros = nnz;
+  m_rowOffsets = offsets;
+  m_columns = cols;
+  m_values = reinterpret_cast<const double*>(base + h.valuesOffset);
+}
+
+/**
+ * @brief y = A x over the mapped arrays
+ * @param a_x Input vector
+ * @param[out] a_y Output vector
+ */
+void MappedCSRMatrix::multiply(const double* a_x, double* a_y) const {
+  const int* offsets = m_rowOffsets;
+  const int* cols = m_columns;
+  const double* vals = m_values;
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < m_numRows; i++) {
+    double sum = 0.0;
+#pragma omp simd reduction(+:sum)
+    for (int k = offsets[i]; k < offsets[i + 1]; k++)
+      sum += vals[k] * a_x[cols[k]];
+    a_y[i] = sum;
+  }
+}
+
+/**
+ * @brief Copy the mapped arrays into a CSRMatrix
+ * @param[out] a_K Matrix
+ */
+void MappedCSRMatrix::copyTo(CSRMatrix& a_K) const {
+  a_K.setPattern(m_numRows, std::vector<int>(m_rowOffsets, m_rowOffsets + m_numRows + 1),
+                 std::vector<int>(m_columns, m_columns + m_numNonzeros));
+  std::copy(m_values, m_values + m_numNonzeros, a_K.values().begin());
+}
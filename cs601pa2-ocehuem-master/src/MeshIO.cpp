@@ -0,0 +1,370 @@
+/**
+ * @file MeshIO.cpp
+ * @brief Implementation of the memory-mapped mesh readers and the .femesh cache
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <charconv>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "Element.h"
+#include "MeshIO.h"
+#include "TextIO.h"
+
+/**
+ * @brief Map a file read-only
+ * @param a_fileName Path of the file to map
+ * @details Empty files are not mapped; data() is nullptr and size() is zero.
+ */
+MappedFile::MappedFile(const std::string& a_fileName) : m_data(nullptr), m_size(0) {
+  int fd = open(a_fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open " + a_fileName);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("Cannot stat " + a_fileName);
+  }
+  m_size = st.st_size;
+  if (m_size > 0) {
+    void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Cannot map " + a_fileName);
+    }
+    madvise(p, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const char*>(p);
+  }
+  close(fd);
+}
+
+/**
+ * @brief Release the mapping
+ */
+MappedFile::~MappedFile() {
+  if (m_data)
+    munmap(const_cast<char*>(m_data), m_size);
+}
+
+namespace {
+
+/**
+ * Parse the leading count of a mesh file and return the start of the body.
+ */
+const char* parseCount(const MappedFile& a_file, const std::string& a_fileName, int& a_count) {
+  const char* end = a_file.data() + a_file.size();
+  const char* p = skipSpace(a_file.data(), end);
+  p = parseField(p, end, a_count);
+  if (!p || a_count < 0)
+    throw std::runtime_error("Missing count in " + a_fileName);
+  return nextLine(p, end);
+}
+
+/**
+ * Split [a_begin, a_end) into line-aligned chunks, one per thread, and call
+ * a_parseLine(line, lineEnd) for every non-blank line. Returns the number of
+ * lines parsed, or -1 if any line failed to parse.
+ */
+template <typename LineParser>
+long parseLinesParallel(const char* a_begin, const char* a_end, LineParser a_parseLine) {
+  bool ok = true;
+  long lines = 0;
+#ifdef _OPENMP
+#pragma omp parallel reduction(&&:ok) reduction(+:lines)
+#endif
+  {
+    int nthreads = 1, tid = 0;
+#ifdef _OPENMP
+    nthreads = omp_get_num_threads();
+    tid = omp_get_thread_num();
+#endif
+    size_t len = a_end - a_begin;
+    const char* p = a_begin + len * tid / nthreads;
+    const char* stop = a_begin + len * (tid + 1) / nthreads;
+    // A chunk owns every line that starts inside it
+    if (tid > 0 && p[-1] != '\n')
+      p = nextLine(p, a_end);
+    if (tid < nthreads - 1 && stop > a_begin && stop[-1] != '\n')
+      stop = nextLine(stop, a_end);
+    while (p < stop) {
+      const char* lineEnd = nextLine(p, a_end);
+      const char* q = skipBlanks(p, lineEnd);
+      if (q < lineEnd && *q != '\n') {
+        ok = a_parseLine(q, lineEnd) && ok;
+        lines++;
+      }
+      p = lineEnd;
+    }
+  }
+  return ok ? lines : -1;
+}
+
+/**
+ * Check that the a_count ids of a file were each seen once: a_lines lines were
+ * parsed and every flag of a_seen is set. With as many lines as ids, an unset
+ * flag means another id was repeated.
+ */
+void checkIds(const std::vector<unsigned char>& a_seen, long a_lines, const std::string& a_fileName) {
+  long count = (long)a_seen.size();
+  if (a_lines != count)
+    throw std::runtime_error(a_fileName + ": count says " + std::to_string(count) + " lines, found " +
+                             std::to_string(a_lines));
+  for (long i = 0; i < count; i++)
+    if (!a_seen[i])
+      throw std::runtime_error(a_fileName + ": id " + std::to_string(i + 1) + " is missing and another id is repeated");
+}
+
+} // namespace
+
+/**
+ * @brief Parse a .node/.elem pair into plain arrays
+ * @details Node lines are "id x y", element lines are "id v0 v1 v2", all ids 1-based.
+ *          Every line is placed by its own id, so the order of lines in the file
+ *          does not matter and chunks can be parsed concurrently. Each line also
+ *          marks its id as seen; the line count and the marks then show any
+ *          missing or repeated id, which would otherwise leave a node at the
+ *          origin or an element with vertex -1.
+ */
+void readTextMesh(const std::string& a_nodeFileName,
+                  const std::string& a_elementFileName,
+                  MeshData& a_mesh) {
+  {
+    MappedFile nodes(a_nodeFileName);
+    int ncount;
+    const char* body = parseCount(nodes, a_nodeFileName, ncount);
+    a_mesh.x.assign(ncount, 0.0);
+    a_mesh.y.assign(ncount, 0.0);
+    a_mesh.boundary.clear();
+    double* x = a_mesh.x.data();
+    double* y = a_mesh.y.data();
+    std::vector<unsigned char> seen(ncount, 0);
+    unsigned char* seenId = seen.data();
+    long lines = parseLinesParallel(body, nodes.data() + nodes.size(),
+      [=](const char* p, const char* end) {
+        int vertex;
+        double xv, yv;
+        if (!(p = parseField(p, end, vertex)) || !(p = parseField(p, end, xv)) ||
+            !parseField(p, end, yv) || vertex < 1 || vertex > ncount)
+          return false;
+        x[vertex-1] = xv;
+        y[vertex-1] = yv;
+#pragma omp atomic write
+        seenId[vertex-1] = 1;
+        return true;
+      });
+    if (lines < 0)
+      throw std::runtime_error("Malformed node line in " + a_nodeFileName);
+    checkIds(seen, lines, a_nodeFileName);
+  }
+
+  MappedFile elements(a_elementFileName);
+  int ncell;
+  const char* body = parseCount(elements, a_elementFileName, ncell);
+  a_mesh.vertices.assign((size_t)ncell * VERTICES, -1);
+  int* vert = a_mesh.vertices.data();
+  int ncount = a_mesh.numNodes();
+  std::vector<unsigned char> seen(ncell, 0);
+  unsigned char* seenId = seen.data();
+  long lines = parseLinesParallel(body, elements.data() + elements.size(),
+    [=](const char* p, const char* end) {
+      int cellID, v[VERTICES];
+      if (!(p = parseField(p, end, cellID)) || cellID < 1 || cellID > ncell)
+        return false;
+      for (int ivert = 0; ivert < VERTICES; ivert++) {
+        if (!(p = parseField(p, end, v[ivert])) || v[ivert] < 1 || v[ivert] > ncount)
+          return false;
+        vert[(size_t)(cellID-1)*VERTICES + ivert] = v[ivert] - 1;
+      }
+#pragma omp atomic write
+      seenId[cellID-1] = 1;
+      return true;
+    });
+  if (lines < 0)
+    throw std::runtime_error("Malformed element line in " + a_elementFileName);
+  checkIds(seen, lines, a_elementFileName);
+}
+
+/**
+ * @brief Write "count" then one "id x y" / "id v0 v1 v2" line per node / element, ids 1-based
+ */
+bool writeTextMesh(const std::string& a_nodeFileName,
+                   const std::string& a_elementFileName,
+                   const MeshData& a_mesh) {
+  FILE* fp = fopen(a_nodeFileName.c_str(), "w");
+  if (!fp)
+    return false;
+  const double* x = a_mesh.x.data();
+  const double* y = a_mesh.y.data();
+  bool ok = fprintf(fp, "%d\n", a_mesh.numNodes()) > 0;
+  ok = ok && writeLinesParallel(fp, a_mesh.numNodes(), [=](size_t i, std::string& line) {
+      appendField(line, (long)i + 1, ' ');
+      appendField(line, x[i], ' ');
+      appendField(line, y[i], '\n');
+    });
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok)
+    return false;
+
+  fp = fopen(a_elementFileName.c_str(), "w");
+  if (!fp)
+    return false;
+  const int* v = a_mesh.vertices.data();
+  ok = fprintf(fp, "%d\n", a_mesh.numElts()) > 0;
+  ok = ok && writeLinesParallel(fp, a_mesh.numElts(), [=](size_t i, std::string& line) {
+      appendField(line, (long)i + 1, ' ');
+      for (int ivert = 0; ivert < VERTICES; ivert++)
+        appendField(line, v[i*VERTICES + ivert] + 1, ivert < VERTICES - 1 ? ' ' : '\n');
+    });
+  ok = (fclose(fp) == 0) && ok;
+  return ok;
+}
+
+/**
+ * @brief Write the header and 64-byte aligned arrays of a .femesh file
+ */
+bool writeMeshCache(const std::string& a_fileName, const MeshData& a_mesh) {
+  FEMeshHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, "FEMESH", 6);
+  h.version = FEMESH_VERSION;
+  bool hasBoundary = (int)a_mesh.boundary.size() == a_mesh.numNodes();
+  h.flags = hasBoundary ? FEMESH_HAS_BOUNDARY : 0;
+  h.numNodes = a_mesh.numNodes();
+  h.numElts = a_mesh.numElts();
+  h.xOffset = align64(sizeof(h));
+  h.yOffset = align64(h.xOffset + sizeof(double) * h.numNodes);
+  h.boundaryOffset = align64(h.yOffset + sizeof(double) * h.numNodes);
+  h.verticesOffset = align64(h.boundaryOffset + h.numNodes);
+  uint64_t total = h.verticesOffset + sizeof(int) * VERTICES * h.numElts;
+
+  // Write to a temporary name and rename, so a reader never maps a partial file
+  std::string tmpName = a_fileName + ".tmp";
+  FILE* fp = fopen(tmpName.c_str(), "wb");
+  if (!fp)
+    return false;
+  static const char zeros[64] = {0};
+  bool ok = true;
+  auto writeAt = [&](uint64_t a_offset, const void* a_data, size_t a_bytes) {
+    long pos = ftell(fp);
+    if (pos >= 0 && (uint64_t)pos < a_offset)
+      ok = ok && fwrite(zeros, 1, a_offset - pos, fp) == a_offset - pos;
+    if (a_bytes > 0)
+      ok = ok && fwrite(a_data, 1, a_bytes, fp) == a_bytes;
+  };
+  std::vector<unsigned char> boundary;
+  if (hasBoundary)
+    boundary = a_mesh.boundary;
+  else
+    boundary.assign(h.numNodes, 0);
+  writeAt(0, &h, sizeof(h));
+  writeAt(h.xOffset, a_mesh.x.data(), sizeof(double) * h.numNodes);
+  writeAt(h.yOffset, a_mesh.y.data(), sizeof(double) * h.numNodes);
+  writeAt(h.boundaryOffset, boundary.data(), h.numNodes);
+  writeAt(h.verticesOffset, a_mesh.vertices.data(), sizeof(int) * VERTICES * h.numElts);
+  ok = ok && (uint64_t)ftell(fp) == total;
+  ok = (fclose(fp) == 0) && ok;
+  if (ok)
+    ok = rename(tmpName.c_str(), a_fileName.c_str()) == 0;
+  if (!ok)
+    remove(tmpName.c_str());
+  return ok;
+}
+
+/**
+ * @brief Map a .femesh file and validate its header, offsets and node numbers
+ * @details Sizes are checked before they are multiplied, so a corrupt header
+ *          cannot overflow the bounds checks.
+ */
+bool mapMeshCache(const std::string& a_fileName, std::unique_ptr<MappedFile>& a_file, MeshView& a_view) {
+  struct stat st;
+  if (stat(a_fileName.c_str(), &st) != 0 || (size_t)st.st_size < sizeof(FEMeshHeader))
+    return false;
+  std::unique_ptr<MappedFile> file(new MappedFile(a_fileName));
+  uint64_t size = file->size();
+  if (size < sizeof(FEMeshHeader))
+    return false;
+  FEMeshHeader h;
+  memcpy(&h, file->data(), sizeof(h));
+  if (memcmp(h.magic, "FEMESH", 6) != 0 || h.version != FEMESH_VERSION ||
+      h.numNodes < 0 || h.numElts < 0 || h.numNodes > INT_MAX || h.numElts > INT_MAX / VERTICES)
+    return false;
+  uint64_t nodeBytes = sizeof(double) * (uint64_t)h.numNodes;
+  uint64_t vertexBytes = sizeof(int) * VERTICES * (uint64_t)h.numElts;
+  // Each array 64-byte aligned, after the header and inside the file
+  auto inside = [&](uint64_t a_offset, uint64_t a_bytes) {
+    return a_offset % 64 == 0 && a_offset >= sizeof(FEMeshHeader) && a_offset <= size && a_bytes <= size - a_offset;
+  };
+  if (!inside(h.xOffset, nodeBytes) || !inside(h.yOffset, nodeBytes) ||
+      !inside(h.boundaryOffset, (uint64_t)h.numNodes) || !inside(h.verticesOffset, vertexBytes))
+    return false;
+
+  const char* base = file->data();
+  MeshView view;
+  view.numNodes = (int)h.numNodes;
+  view.numElts = (int)h.numElts;
+  view.x = reinterpret_cast<const double*>(base + h.xOffset);
+  view.y = reinterpret_cast<const double*>(base + h.yOffset);
+  view.boundary = (h.flags & FEMESH_HAS_BOUNDARY) ? reinterpret_cast<const unsigned char*>(base + h.boundaryOffset)
+                                                  : nullptr;
+  view.vertices = reinterpret_cast<const int*>(base + h.verticesOffset);
+  const int* v = view.vertices;
+  long count = (long)VERTICES * view.numElts;
+  int numNodes = view.numNodes;
+  bool ok = true;
+#pragma omp parallel for simd reduction(&&:ok) schedule(static)
+  for (long k = 0; k < count; k++)
+    ok = ok && v[k] >= 0 && v[k] < numNodes;
+  if (!ok)
+    return false;
+  a_file = std::move(file);
+  a_view = view;
+  return true;
+}
+
+/**
+ * @brief Map a .femesh file and copy its arrays out
+ */
+bool readMeshCache(const std::string& a_fileName, MeshData& a_mesh) {
+  std::unique_ptr<MappedFile> file;
+  MeshView v;
+  if (!mapMeshCache(a_fileName, file, v))
+    return false;
+  a_mesh.x.assign(v.x, v.x + v.numNodes);
+  a_mesh.y.assign(v.y, v.y + v.numNodes);
+  if (v.boundary)
+    a_mesh.boundary.assign(v.boundary, v.boundary + v.numNodes);
+  else
+    a_mesh.boundary.clear();
+  a_mesh.vertices.assign(v.vertices, v.vertices + (size_t)VERTICES * v.numElts);
+  return true;
+}
+
+/**
+ * @brief Compare modification times of a cache file and its sources
+ */
+bool meshCacheIsFresh(const std::string& a_cacheFileName,
+                      const std::vector<std::string>& a_sources) {
+  struct stat cache;
+  if (stat(a_cacheFileName.c_str(), &cache) != 0)
+    return false;
+  for (size_t i = 0; i < a_sources.size(); i++) {
+    struct stat src;
+    if (stat(a_sources[i].c_str(), &src) != 0)
+      return false;
+    if (src.st_mtim.tv_sec > cache.st_mtim.tv_sec ||
+        (src.st_mtim.tv_sec == cache.st_mtim.tv_sec &&
+         src.st_mtim.tv_nsec > cache.st_mtim.tv_nsec))
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,368 @@
+/**
+ * @file MeshPartition.cpp
+ * @brief Implementation of RCB partitioning and the partitioned stiffness operator
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include "MeshPartition.h"
+
+/**
+ * @brief Default constructor
+ */
+MeshPartition::MeshPartition() : m_edgeCut(0) { }
+
+/**
+ * @brief Recursive coordinate bisection of a range of rows
+ * @param a_rows Row indices; the range is reordered in place
+ * @param a_begin First row of the range
+ * @param a_end One past the last row
+ * @param a_firstPart Number of the first part of the range
+ * @param a_numParts Parts to cut the range into
+ * @param a_x X coordinate of every row
+ * @param a_y Y coordinate of every row
+ * @details With an odd number of parts the cut is not at the median but at
+ *          the fraction of rows given to the lower half, so every part gets
+ *          n/P rows within one.
+ */
+void MeshPartition::bisect(std::vector<int>& a_rows, int a_begin, int a_end, int a_firstPart, int a_numParts,
+                           const double* a_x, const double* a_y) {
+  if (a_numParts == 1)
+    {
+      for (int i = a_begin; i < a_end; i++)
+        m_rowPart[a_rows[i]] = a_firstPart;
+      return;
+    }
+  double xmin = 1e300, xmax = -1e300, ymin = 1e300, ymax = -1e300;
+  for (int i = a_begin; i < a_end; i++)
+    {
+      int r = a_rows[i];
+      xmin = std::min(xmin, a_x[r]);
+      xmax = std::max(xmax, a_x[r]);
+      ymin = std::min(ymin, a_y[r]);
+      ymax = std::max(ymax, a_y[r]);
+    }
+  const double* coord = (xmax - xmin >= ymax - ymin) ? a_x : a_y;
+  int lowerParts = a_numParts / 2;
+  int mid = a_begin + (int)((long)(a_end - a_begin) * lowerParts / a_numParts);
+  std::nth_element(a_rows.begin() + a_begin, a_rows.begin() + mid, a_rows.begin() + a_end,
+                   [coord](int a, int b) { return coord[a] < coord[b] || (coord[a] == coord[b] && a < b); });
+  bisect(a_rows, a_begin, mid, a_firstPart, lowerParts, a_x, a_y);
+  bisect(a_rows, mid, a_end, a_firstPart + lowerParts, a_numParts - lowerParts, a_x, a_y);
+}
+
+/**
+ * @brief Partition, then build the local numbering, patterns and halo lists of every part
+ * @param a_grid Grid
+ * @param a_assembler Assembler of a_grid
+ * @param a_numParts Number of parts
+ * @details Local numbering of a part: its owned rows in increasing global order,
+ *          then its ghosts sorted by owning part and global row, so the ghosts
+ *          received from one neighbour are contiguous and arrive in the order the
+ *          neighbour packs them.
+ */
+void MeshPartition::build(const FEGrid& a_grid, const StiffnessAssembler& a_assembler, int a_numParts) {
+  const std::vector<int>& rowOf = a_assembler.globalMatrixIndex();
+  const std::vector<int>& rowNode = a_assembler.rowNode();
+  int n = a_assembler.getNumRows();
+  int ne = a_grid.getNumElts();
+  std::vector<double> rowX(n), rowY(n);
+  for (int r = 0; r < n; r++)
+    {
+      rowX[r] = a_grid.xCoords()[rowNode[r]];
+      rowY[r] = a_grid.yCoords()[rowNode[r]];
+    }
+  std::vector<int> rows(n);
+  for (int r = 0; r < n; r++)
+    rows[r] = r;
+  m_rowPart.assign(n, 0);
+  bisect(rows, 0, n, 0, a_numParts, rowX.data(), rowY.data());
+
+  m_parts.assign(a_numParts, Part());
+  // local index of every row in its owner, owned rows in increasing order
+  std::vector<int> ownedIndex(n);
+  for (int r = 0; r < n; r++)
+    {
+      Part& part = m_parts[m_rowPart[r]];
+      ownedIndex[r] = (int)part.rows.size();
+      part.rows.push_back(r);
+    }
+
+  // home part of every element: the part owning most of its interior vertices
+  m_elementPart.assign(ne, -1);
+  const int* v[VERTICES];
+  for (int k = 0; k < VERTICES; k++)
+    v[k] = a_grid.vertexArray(k);
+  for (int e = 0; e < ne; e++)
+    {
+      int parts[VERTICES];
+      int count = 0;
+      for (int k = 0; k < VERTICES; k++)
+        if (rowOf[v[k][e]] >= 0)
+          parts[count++] = m_rowPart[rowOf[v[k][e]]];
+      for (int i = 1; i < count; i++)
+        for (int j = i; j > 0 && parts[j - 1] > parts[j]; j--)
+          std::swap(parts[j - 1], parts[j]);
+      int best = -1, bestCount = 0;
+      for (int i = 0; i < count; )
+        {
+          int j = i;
+          while (j < count && parts[j] == parts[i])
+            j++;
+          if (j - i > bestCount)
+            {
+              best = parts[i];
+              bestCount = j - i;
+            }
+          i = j;
+        }
+      m_elementPart[e] = best;
+      // every part owning a vertex assembles the element
+      for (int i = 0; i < count; i++)
+        if (i == 0 || parts[i] != parts[i - 1])
+          m_parts[parts[i]].elements.push_back(e);
+    }
+
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int p = 0; p < a_numParts; p++)
+    {
+      Part& part = m_parts[p];
+      part.numOwned = (int)part.rows.size();
+      auto ghostKey = [this](int r) { return std::make_pair(m_rowPart[r], r); };
+      auto ghostLess = [&ghostKey](int a, int b) { return ghostKey(a) < ghostKey(b); };
+
+      std::vector<int> ghosts;
+      for (int e : part.elements)
+        for (int k = 0; k < VERTICES; k++)
+          {
+            int r = rowOf[v[k][e]];
+            if (r >= 0 && m_rowPart[r] != p)
+              ghosts.push_back(r);
+          }
+      std::sort(ghosts.begin(), ghosts.end(), ghostLess);
+      ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+      part.rows.insert(part.rows.end(), ghosts.begin(), ghosts.end());
+      auto localIndex = [&](int r) {
+        if (m_rowPart[r] == p)
+          return ownedIndex[r];
+        return part.numOwned + (int)(std::lower_bound(ghosts.begin(), ghosts.end(), r, ghostLess) - ghosts.begin());
+      };
+
+      part.neighbours.clear();
+      part.recvOffsets.assign(1, 0);
+      for (size_t g = 0; g < ghosts.size(); g++)
+        {
+          int owner = m_rowPart[ghosts[g]];
+          if (part.neighbours.empty() || part.neighbours.back() != owner)
+            {
+              if (!part.neighbours.empty())
+                part.recvOffsets.push_back((int)g);
+              part.neighbours.push_back(owner);
+            }
+        }
+      if (!part.neighbours.empty())
+        part.recvOffsets.push_back((int)ghosts.size());
+
+      // pattern of the owned rows in local columns
+      std::vector<int> local(part.elements.size() * VERTICES);
+      for (size_t i = 0; i < part.elements.size(); i++)
+        for (int k = 0; k < VERTICES; k++)
+          {
+            int r = rowOf[v[k][part.elements[i]]];
+            local[i * VERTICES + k] = r >= 0 ? localIndex(r) : -1;
+          }
+      std::vector<std::vector<int> > rowColumns(part.numOwned);
+      for (size_t i = 0; i < part.elements.size(); i++)
+        for (int a = 0; a < VERTICES; a++)
+          {
+            int la = local[i * VERTICES + a];
+            if (la < 0 || la >= part.numOwned)
+              continue;
+            for (int b = 0; b < VERTICES; b++)
+              if (local[i * VERTICES + b] >= 0)
+                rowColumns[la].push_back(local[i * VERTICES + b]);
+          }
+      part.offsets.assign(part.numOwned + 1, 0);
+      part.columns.clear();
+      for (int i = 0; i < part.numOwned; i++)
+        {
+          std::vector<int>& cols = rowColumns[i];
+          std::sort(cols.begin(), cols.end());
+          cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+          part.columns.insert(part.columns.end(), cols.begin(), cols.end());
+          part.offsets[i + 1] = (int)part.columns.size();
+        }
+      part.values.assign(part.columns.size(), 0.0);
+
+      part.slots.assign(part.elements.size() * VERTICES * VERTICES, -1);
+      for (size_t i = 0; i < part.elements.size(); i++)
+        for (int a = 0; a < VERTICES; a++)
+          {
+            int la = local[i * VERTICES + a];
+            if (la < 0 || la >= part.numOwned)
+              continue;
+            for (int b = 0; b < VERTICES; b++)
+              {
+                int lb = local[i * VERTICES + b];
+                if (lb < 0)
+                  continue;
+                const int* begin = part.columns.data() + part.offsets[la];
+                const int* end = part.columns.data() + part.offsets[la + 1];
+                part.slots[(i * VERTICES + a) * VERTICES + b] = (int)(std::lower_bound(begin, end, lb) - part.columns.data());
+              }
+          }
+      part.x.assign(part.rows.size(), 0.0);
+      part.y.assign(part.numOwned, 0.0);
+    }
+
+  // send lists: what part q sends to p is p's ghosts owned by q, in p's order.
+  // The matrix is symmetric, so q's neighbours are exactly the parts that have q as neighbour.
+  for (int q = 0; q < a_numParts; q++)
+    {
+      m_parts[q].sendOffsets.assign(1, 0);
+      m_parts[q].sendIndices.clear();
+    }
+  for (int q = 0; q < a_numParts; q++)
+    {
+      Part& sender = m_parts[q];
+      for (int p : sender.neighbours)
+        {
+          Part& receiver = m_parts[p];
+          size_t k = std::lower_bound(receiver.neighbours.begin(), receiver.neighbours.end(), q) - receiver.neighbours.begin();
+          assert(k < receiver.neighbours.size() && receiver.neighbours[k] == q);
+          for (int g = receiver.recvOffsets[k]; g < receiver.recvOffsets[k + 1]; g++)
+            sender.sendIndices.push_back(ownedIndex[receiver.rows[receiver.numOwned + g]]);
+          sender.sendOffsets.push_back((int)sender.sendIndices.size());
+        }
+      sender.sendBuffer.assign(sender.sendIndices.size(), 0.0);
+    }
+  for (int p = 0; p < a_numParts; p++)
+    {
+      Part& receiver = m_parts[p];
+      receiver.recvSource.resize(receiver.neighbours.size());
+      for (size_t k = 0; k < receiver.neighbours.size(); k++)
+        {
+          const Part& sender = m_parts[receiver.neighbours[k]];
+          size_t j = std::lower_bound(sender.neighbours.begin(), sender.neighbours.end(), p) - sender.neighbours.begin();
+          receiver.recvSource[k] = sender.sendOffsets[j];
+        }
+    }
+
+  m_edgeCut = 0;
+  for (const Part& part : m_parts)
+    for (int i = 0; i < part.numOwned; i++)
+      for (int k = part.offsets[i]; k < part.offsets[i + 1]; k++)
+        if (part.columns[k] >= part.numOwned && part.rows[i] < part.rows[part.columns[k]])
+          m_edgeCut++;
+}
+
+/**
+ * @brief Owner-computes assembly, one part per thread
+ * @param a_assembler Assembler given to build()
+ */
+void MeshPartition::assemble(const StiffnessAssembler& a_assembler) {
+  int numParts = getNumParts();
+#pragma omp parallel for schedule(static, 1)
+  for (int p = 0; p < numParts; p++)
+    {
+      Part& part = m_parts[p];
+      std::fill(part.values.begin(), part.values.end(), 0.0);
+      double kij[VERTICES*VERTICES];
+      double kijpartial[VERTICES*DIM];
+      double* values = part.values.data();
+      for (size_t i = 0; i < part.elements.size(); i++)
+        {
+          a_assembler.elementMatrix(part.elements[i], kij, kijpartial);
+          const int* slots = &part.slots[i * VERTICES * VERTICES];
+          for (int k = 0; k < VERTICES*VERTICES; k++)
+            if (slots[k] >= 0)
+              values[slots[k]] += kij[k];
+        }
+    }
+}
+
+/**
+ * @brief Scatter a global vector to the owners
+ * @param a_x Global vector
+ */
+void MeshPartition::distribute(const double* a_x) {
+  int numParts = getNumParts();
+#pragma omp parallel for schedule(static, 1)
+  for (int p = 0; p < numParts; p++)
+    {
+      Part& part = m_parts[p];
+      for (int i = 0; i < part.numOwned; i++)
+        part.x[i] = a_x[part.rows[i]];
+    }
+}
+
+/**
+ * @brief Pack, then (after the barrier ending the first loop) unpack the halos
+ * @details A part only writes its own send buffer and its own ghosts, and only
+ *          reads its neighbours' send buffers, as with MPI sends and receives.
+ */
+void MeshPartition::exchangeHalo() {
+  int numParts = getNumParts();
+#pragma omp parallel
+  {
+#pragma omp for schedule(static, 1)
+    for (int p = 0; p < numParts; p++)
+      {
+        Part& part = m_parts[p];
+        for (size_t i = 0; i < part.sendIndices.size(); i++)
+          part.sendBuffer[i] = part.x[part.sendIndices[i]];
+      }
+#pragma omp for schedule(static, 1)
+    for (int p = 0; p < numParts; p++)
+      {
+        Part& part = m_parts[p];
+        for (size_t k = 0; k < part.neighbours.size(); k++)
+          {
+            const double* source = m_parts[part.neighbours[k]].sendBuffer.data() + part.recvSource[k];
+            std::copy(source, source + (part.recvOffsets[k + 1] - part.recvOffsets[k]),
+                      part.x.begin() + part.numOwned + part.recvOffsets[k]);
+          }
+      }
+  }
+}
+
+/**
+ * @brief Partitioned K x
+ */
+void MeshPartition::multiply() {
+  exchangeHalo();
+  int numParts = getNumParts();
+#pragma omp parallel for schedule(static, 1)
+  for (int p = 0; p < numParts; p++)
+    {
+      Part& part = m_parts[p];
+      const int* offsets = part.offsets.data();
+      const int* cols = part.columns.data();
+      const double* vals = part.values.data();
+      const double* x = part.x.data();
+      for (int i = 0; i < part.numOwned; i++)
+        {
+          double sum = 0.0;
+#pragma omp simd reduction(+:sum)
+          for (int k = offsets[i]; k < offsets[i + 1]; k++)
+            sum += vals[k] * x[cols[k]];
+          part.y[i] = sum;
+        }
+    }
+}
+
+/**
+ * @brief Gather the owned entries of y
+ * @param[out] a_y Global vector
+ */
+void MeshPartition::collect(double* a_y) const {
+  int numParts = getNumParts();
+#pragma omp parallel for schedule(static, 1)
+  for (int p = 0; p < numParts; p++)
+    {
+      const Part& part = m_parts[p];
+      for (int i = 0; i < part.numOwned; i++)
+        a_y[part.rows[i]] = part.y[i];
+    }
+}
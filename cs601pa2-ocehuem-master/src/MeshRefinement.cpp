@@ -0,0 +1,226 @@
+/**
+ * @file MeshRefinement.cpp
+ * @brief Implementation of parallel uniform triangle refinement
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "Element.h"
+#include "MeshRefinement.h"
+
+namespace {
+
+/**
+ * Lock-free open-addressing hash table of edges. A key packs the two end nodes
+ * (smaller first); each slot also packs how many half-edges were inserted for
+ * its edge (high 32 bits) and the smallest of them (low 32 bits), where half-edge
+ * 3*e+k is local edge k of element e.
+ */
+class EdgeTable {
+public:
+  explicit EdgeTable(size_t a_numEdges) : m_bits(6) {
+    while ((size_t(1) << m_bits) < 2 * a_numEdges)
+      m_bits++;
+    size_t size = size_t(1) << m_bits;
+    m_keys.reset(new std::atomic<uint64_t>[size]);
+    m_info.reset(new std::atomic<uint64_t>[size]);
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < size; i++) {
+      m_keys[i].store(0, std::memory_order_relaxed);
+      m_info[i].store(EMPTY_INFO, std::memory_order_relaxed);
+    }
+  }
+
+  /// Key of the edge between nodes a and b; never zero since the nodes differ
+  static uint64_t key(int a_a, int a_b) {
+    return a_a < a_b ? (uint64_t(a_a) << 32 | uint32_t(a_b)) : (uint64_t(a_b) << 32 | uint32_t(a_a));
+  }
+
+  /// Add one half-edge of an edge; returns the slot of the edge
+  uint32_t insert(uint64_t a_key, uint32_t a_halfEdge) {
+    size_t mask = (size_t(1) << m_bits) - 1;
+    size_t slot = hash(a_key);
+    while (true) {
+      uint64_t k = m_keys[slot].load(std::memory_order_acquire);
+      if (k == 0 && m_keys[slot].compare_exchange_strong(k, a_key))
+        break;
+      if (k == a_key)
+        break;
+      slot = (slot + 1) & mask;
+    }
+    uint64_t old = m_info[slot].load(std::memory_order_relaxed);
+    uint64_t desired;
+    do {
+      uint32_t count = uint32_t(old >> 32) + 1;
+      uint32_t first = std::min(uint32_t(old), a_halfEdge);
+      desired = uint64_t(count) << 32 | first;
+    } while (!m_info[slot].compare_exchange_weak(old, desired));
+    return (uint32_t)slot;
+  }
+
+  /// @return Smallest half-edge of the edge in a_slot
+  uint32_t owner(uint32_t a_slot) const { return uint32_t(m_info[a_slot].load(std::memory_order_relaxed)); }
+
+  /// @return Number of elements sharing the edge in a_slot
+  uint32_t count(uint32_t a_slot) const { return uint32_t(m_info[a_slot].load(std::memory_order_relaxed) >> 32); }
+
+private:
+  static const uint64_t EMPTY_INFO = 0xFFFFFFFFull;  ///< count 0, owner "infinity"
+
+  /// Fibonacci hashing into m_bits bits
+  size_t hash(uint64_t a_key) const { return size_t((a_key * 0x9E3779B97F4A7C15ull) >> (64 - m_bits)); }
+
+  int m_bits;                                    ///< log2 of the table size
+  std::unique_ptr<std::atomic<uint64_t>[]> m_keys; ///< Edge keys, 0 = empty
+  std::unique_ptr<std::atomic<uint64_t>[]> m_info; ///< Count and first half-edge per edge
+};
+
+/// Number of set bits below bit a_k of a 3-bit mask
+inline int rankBelow(unsigned char a_mask, int a_k) {
+  return __builtin_popcount(a_mask & ((1u << a_k) - 1));
+}
+
+} // namespace
+
+/**
+ * @brief Split every triangle into four through shared edge midpoints
+ * @details Five parallel passes over the elements:
+ *          1. insert every half-edge into the edge table;
+ *          2. mark the edges an element owns (it holds their smallest half-edge);
+ *          3. prefix sum of owned edges per element gives every edge its midpoint number;
+ *          4. owners create the midpoints and flag the nodes of single-element edges;
+ *          5. every element writes its four children.
+ */
+void refineMesh(const MeshData& a_coarse, MeshData& a_fine, std::vector<int>* a_midpointEnds) {
+  int nn = a_coarse.numNodes();
+  int ne = a_coarse.numElts();
+  assert((uint64_t)VERTICES * ne < 0xFFFFFFFFull);
+  const int* v = a_coarse.vertices.data();
+
+  // E = (3 ne + boundary edges) / 2 and there are at most nn boundary edges
+  EdgeTable table((size_t)3 * ne / 2 + nn + 1);
+  std::vector<uint32_t> slot((size_t)VERTICES * ne);
+#pragma omp parallel for schedule(static)
+  for (int e = 0; e < ne; e++)
+    for (int k = 0; k < VERTICES; k++) {
+      size_t h = (size_t)e * VERTICES + k;
+      slot[h] = table.insert(EdgeTable::key(v[h], v[(size_t)e * VERTICES + (k + 1) % VERTICES]), (uint32_t)h);
+    }
+
+  std::vector<unsigned char> owned(ne);
+#pragma omp parallel for schedule(static)
+  for (int e = 0; e < ne; e++) {
+    unsigned char mask = 0;
+    for (int k = 0; k < VERTICES; k++)
+      if (table.owner(slot[(size_t)e * VERTICES + k]) == (uint32_t)e * VERTICES + k)
+        mask |= 1 << k;
+    owned[e] = mask;
+  }
+
+  // exclusive prefix sum of owned edge counts, one block per thread of the
+  // team actually started (the runtime may give fewer than requested)
+  std::vector<int> edgeBase(ne + 1, 0);
+  int maxThreads = 1, nthreads = 1;
+#ifdef _OPENMP
+  maxThreads = omp_get_max_threads();
+#endif
+  std::vector<int> blockSum(maxThreads + 1, 0);
+#pragma omp parallel num_threads(maxThreads)
+  {
+    int tid = 0, team = 1;
+#ifdef _OPENMP
+    tid = omp_get_thread_num();
+    team = omp_get_num_threads();
+#endif
+    int begin = (int)((long)ne * tid / team), end = (int)((long)ne * (tid + 1) / team);
+    int sum = 0;
+    for (int e = begin; e < end; e++)
+      sum += __builtin_popcount(owned[e]);
+    blockSum[tid + 1] = sum;
+#pragma omp barrier
+#pragma omp single
+    {
+      nthreads = team;
+      for (int t = 0; t < team; t++)
+        blockSum[t + 1] += blockSum[t];
+    }
+    sum = blockSum[tid];
+    for (int e = begin; e < end; e++) {
+      edgeBase[e] = sum;
+      sum += __builtin_popcount(owned[e]);
+    }
+  }
+  int numEdges = blockSum[nthreads];
+  edgeBase[ne] = numEdges;
+
+  int fineNodes = nn + numEdges;
+  a_fine.x.resize(fineNodes);
+  a_fine.y.resize(fineNodes);
+  a_fine.boundary.assign(fineNodes, 0);
+  a_fine.vertices.resize((size_t)4 * VERTICES * ne);
+  double* x = a_fine.x.data();
+  double* y = a_fine.y.data();
+  unsigned char* boundary = a_fine.boundary.data();
+  int* ends = nullptr;
+  if (a_midpointEnds) {
+    a_midpointEnds->resize((size_t)2 * numEdges);
+    ends = a_midpointEnds->data();
+  }
+  const bool coarseFlags = (int)a_coarse.boundary.size() == nn;
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < nn; i++) {
+    x[i] = a_coarse.x[i];
+    y[i] = a_coarse.y[i];
+    if (coarseFlags && a_coarse.boundary[i])
+      boundary[i] = 1;
+  }
+
+#pragma omp parallel for schedule(static)
+  for (int e = 0; e < ne; e++)
+    for (int k = 0; k < VERTICES; k++) {
+      if (!(owned[e] & (1 << k)))
+        continue;
+      int a = v[(size_t)e * VERTICES + k], b = v[(size_t)e * VERTICES + (k + 1) % VERTICES];
+      int mid = nn + edgeBase[e] + rankBelow(owned[e], k);
+      x[mid] = 0.5 * (a_coarse.x[a] + a_coarse.x[b]);
+      y[mid] = 0.5 * (a_coarse.y[a] + a_coarse.y[b]);
+      if (ends) {
+        ends[(size_t)2 * (mid - nn)] = a;
+        ends[(size_t)2 * (mid - nn) + 1] = b;
+      }
+      if (table.count(slot[(size_t)e * VERTICES + k]) == 1) {
+        boundary[mid] = 1;
+        // an end node may be flagged by two threads; the value is the same
+#pragma omp atomic write
+        boundary[a] = 1;
+#pragma omp atomic write
+        boundary[b] = 1;
+      }
+    }
+
+  int* fv = a_fine.vertices.data();
+#pragma omp parallel for schedule(static)
+  for (int e = 0; e < ne; e++) {
+    int m[VERTICES];
+    for (int k = 0; k < VERTICES; k++) {
+      uint32_t h = table.owner(slot[(size_t)e * VERTICES + k]);
+      int oe = h / VERTICES, ok = h % VERTICES;
+      m[k] = nn + edgeBase[oe] + rankBelow(owned[oe], ok);
+    }
+    const int* c = v + (size_t)e * VERTICES;
+    int children[4][VERTICES] = {{c[0], m[0], m[2]},
+                                 {m[0], c[1], m[1]},
+                                 {m[2], m[1], c[2]},
+                                 {m[0], m[1], m[2]}};
+    for (int child = 0; child < 4; child++)
+      for (int k = 0; k < VERTICES; k++)
+        fv[((size_t)4 * e + child) * VERTICES + k] = children[child][k];
+  }
+}
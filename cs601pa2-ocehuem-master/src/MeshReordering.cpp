@@ -0,0 +1,139 @@
+/**
+ * @file MeshReordering.cpp
+ * @brief Implementation of Morton/Hilbert element ordering with first-touch node numbering
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Element.h"
+#include "MeshReordering.h"
+
+namespace {
+
+/// Bits per coordinate of the curve grid
+const int CURVE_BITS = 16;
+
+/// Spread the low 16 bits of a_v to the even bits of the result
+inline uint32_t spreadBits(uint32_t a_v) {
+  a_v &= 0xFFFF;
+  a_v = (a_v | (a_v << 8)) & 0x00FF00FF;
+  a_v = (a_v | (a_v << 4)) & 0x0F0F0F0F;
+  a_v = (a_v | (a_v << 2)) & 0x33333333;
+  a_v = (a_v | (a_v << 1)) & 0x55555555;
+  return a_v;
+}
+
+/// Z-order key: bits of x and y interleaved
+inline uint32_t mortonKey(uint32_t a_x, uint32_t a_y) {
+  return spreadBits(a_x) | (spreadBits(a_y) << 1);
+}
+
+/// Distance along the Hilbert curve filling the 2^16 x 2^16 grid
+inline uint32_t hilbertKey(uint32_t a_x, uint32_t a_y) {
+  const uint32_t n = 1u << CURVE_BITS;
+  uint32_t d = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    uint32_t rx = (a_x & s) > 0;
+    uint32_t ry = (a_y & s) > 0;
+    d += s * s * ((3 * rx) ^ ry);
+    // rotate the quadrant so the sub-curve starts and ends at the right corners
+    if (ry == 0) {
+      if (rx == 1) {
+        a_x = n - 1 - a_x;
+        a_y = n - 1 - a_y;
+      }
+      std::swap(a_x, a_y);
+    }
+  }
+  return d;
+}
+
+} // namespace
+
+/**
+ * @brief Sort elements by curve key of the centroid, then number nodes by first touch
+ * @details Each element's 32-bit key and number are packed into one 64-bit word,
+ *          so a plain sort is stable with respect to the old element order.
+ */
+void reorderMesh(const MeshData& a_in, MeshData& a_out, SpaceFillingCurve a_curve,
+                 std::vector<int>* a_newToOldElement, std::vector<int>* a_newToOldNode) {
+  int nn = a_in.numNodes();
+  int ne = a_in.numElts();
+  const int* v = a_in.vertices.data();
+  double xmin = 0.0, xmax = 0.0, ymin = 0.0, ymax = 0.0;
+  if (nn > 0) {
+    auto xr = std::minmax_element(a_in.x.begin(), a_in.x.end());
+    auto yr = std::minmax_element(a_in.y.begin(), a_in.y.end());
+    xmin = *xr.first;
+    xmax = *xr.second;
+    ymin = *yr.first;
+    ymax = *yr.second;
+  }
+  const double cells = (double)((1u << CURVE_BITS) - 1);
+  double xscale = xmax > xmin ? cells / (xmax - xmin) : 0.0;
+  double yscale = ymax > ymin ? cells / (ymax - ymin) : 0.0;
+
+  std::vector<uint64_t> order(ne);
+#pragma omp parallel for schedule(static)
+  for (int e = 0; e < ne; e++) {
+    double cx = 0.0, cy = 0.0;
+    for (int k = 0; k < VERTICES; k++) {
+      cx += a_in.x[v[(size_t)e * VERTICES + k]];
+      cy += a_in.y[v[(size_t)e * VERTICES + k]];
+    }
+    uint32_t ix = (uint32_t)((cx / VERTICES - xmin) * xscale + 0.5);
+    uint32_t iy = (uint32_t)((cy / VERTICES - ymin) * yscale + 0.5);
+    uint32_t key = a_curve == HILBERT ? hilbertKey(ix, iy) : mortonKey(ix, iy);
+    order[e] = (uint64_t)key << 32 | (uint32_t)e;
+  }
+  std::sort(order.begin(), order.end());
+
+  // first touch: nodes numbered in the order the sorted elements reach them
+  std::vector<int> newNode(nn, -1);
+  std::vector<int> oldNode;
+  oldNode.reserve(nn);
+  for (int i = 0; i < ne; i++) {
+    int e = (int)(uint32_t)order[i];
+    for (int k = 0; k < VERTICES; k++) {
+      int node = v[(size_t)e * VERTICES + k];
+      if (newNode[node] < 0) {
+        newNode[node] = (int)oldNode.size();
+        oldNode.push_back(node);
+      }
+    }
+  }
+  for (int node = 0; node < nn; node++)
+    if (newNode[node] < 0) {
+      newNode[node] = (int)oldNode.size();
+      oldNode.push_back(node);
+    }
+
+  const bool flags = (int)a_in.boundary.size() == nn;
+  a_out.x.resize(nn);
+  a_out.y.resize(nn);
+  a_out.boundary.assign(flags ? nn : 0, 0);
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < nn; i++) {
+    a_out.x[i] = a_in.x[oldNode[i]];
+    a_out.y[i] = a_in.y[oldNode[i]];
+    if (flags)
+      a_out.boundary[i] = a_in.boundary[oldNode[i]];
+  }
+  a_out.vertices.resize((size_t)ne * VERTICES);
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < ne; i++) {
+    int e = (int)(uint32_t)order[i];
+    for (int k = 0; k < VERTICES; k++)
+      a_out.vertices[(size_t)i * VERTICES + k] = newNode[v[(size_t)e * VERTICES + k]];
+  }
+
+  if (a_newToOldElement) {
+    a_newToOldElement->resize(ne);
+    for (int i = 0; i < ne; i++)
+      (*a_newToOldElement)[i] = (int)(uint32_t)order[i];
+  }
+  if (a_newToOldNode)
+    a_newToOldNode->swap(oldNode);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file MeshTopology.cpp
+ * @brief Implementation of the linear-time mesh adjacency builder
+ */
+
+#include <cassert>
+#include <vector>
+#include "MeshTopology.h"
+
+/**
+ * @brief Default constructor
+ * @details An empty topology has one (zero) offset in each CSR offset array.
+ */
+MeshTopology::MeshTopology() : m_nodeEltOffsets(1, 0), m_eltEltOffsets(1, 0) { }
+
+/**
+ * @brief Build node-to-element, element-to-element and boundary information
+ * @param a_numNodes Number of nodes in the mesh
+ * @param a_elements Elements of the mesh
+ * @details
+ *  1. Node-to-element CSR by counting sort over the connectivity.
+ *  2. For every local edge (a,b) of element e, the neighbor is the other element
+ *     in the list of node a that also contains b. Node degrees are bounded for
+ *     triangle meshes, so the whole pass is O(number of elements).
+ *  3. Edges without a neighbor are boundary edges; their end points are boundary nodes.
+ */
+void MeshTopology::build(int a_numNodes, const std::vector<Element>& a_elements) {
+  int ncell = a_elements.size();
+
+  // 1. node -> element
+  m_nodeEltOffsets.assign(a_numNodes + 1, 0);
+  for (int e = 0; e < ncell; e++)
+    for (int ivert = 0; ivert < VERTICES; ivert++)
+      {
+        assert(a_elements[e][ivert] >= 0 && a_elements[e][ivert] < a_numNodes);
+        m_nodeEltOffsets[a_elements[e][ivert] + 1]++;
+      }
+  for (int i = 0; i < a_numNodes; i++)
+    m_nodeEltOffsets[i + 1] += m_nodeEltOffsets[i];
+  m_nodeElts.resize(m_nodeEltOffsets[a_numNodes]);
+  std::vector<int> fill(m_nodeEltOffsets.begin(), m_nodeEltOffsets.end() - 1);
+  for (int e = 0; e < ncell; e++)
+    for (int ivert = 0; ivert < VERTICES; ivert++)
+      m_nodeElts[fill[a_elements[e][ivert]]++] = e;
+
+  // 2. element -> element across edges
+  m_edgeNeighbors.assign(ncell * VERTICES, -1);
+  m_eltEltOffsets.assign(ncell + 1, 0);
+  m_boundaryEdges.clear();
+  m_boundaryEdgeElts.clear();
+  m_isBoundaryNode.assign(a_numNodes, 0);
+  for (int e = 0; e < ncell; e++)
+    {
+      const Element& elt = a_elements[e];
+      int count = 0;
+      for (int iedge = 0; iedge < VERTICES; iedge++)
+        {
+          int a = elt[iedge];
+          int b = elt[(iedge + 1) % VERTICES];
+          int neighbor = -1;
+          for (int k = m_nodeEltOffsets[a]; k < m_nodeEltOffsets[a + 1] && neighbor < 0; k++)
+            {
+              int f = m_nodeElts[k];
+              if (f == e)
+                continue;
+              const Element& other = a_elements[f];
+              for (int jvert = 0; jvert < VERTICES; jvert++)
+                if (other[jvert] == b)
+                  neighbor = f;
+            }
+          m_edgeNeighbors[e * VERTICES + iedge] = neighbor;
+          if (neighbor >= 0)
+            count++;
+          else
+            {
+              // 3. boundary edge owned by e alone
+              m_boundaryEdges.push_back(a);
+              m_boundaryEdges.push_back(b);
+              m_boundaryEdgeElts.push_back(e);
+              m_isBoundaryNode[a] = 1;
+              m_isBoundaryNode[b] = 1;
+            }
+        }
+      m_eltEltOffsets[e + 1] = m_eltEltOffsets[e] + count;
+    }
+
+  m_eltElts.resize(m_eltEltOffsets[ncell]);
+  for (int e = 0; e < ncell; e++)
+    {
+      int k = m_eltEltOffsets[e];
+      for (int iedge = 0; iedge < VERTICES; iedge++)
+        if (m_edgeNeighbors[e * VERTICES + iedge] >= 0)
+          m_eltElts[k++] = m_edgeNeighbors[e * VERTICES + iedge];
+    }
+}
@@ -0,0 +1,392 @@
+/**
+ * @file Multigrid.cpp
+ * @brief Implementation of the geometric multigrid V-cycle
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "Multigrid.h"
+#include "MeshRefinement.h"
+#include "StiffnessAssembler.h"
+
+/**
+ * @brief Default constructor
+ */
+Multigrid::Multigrid() : m_preSweeps(2), m_postSweeps(2), m_relativeResidual(0.0) { }
+
+/**
+ * @brief Destructor
+ */
+Multigrid::~Multigrid() { }
+
+/**
+ * @brief Set the number of smoothing sweeps
+ * @param a_preSweeps Forward sweeps
+ * @param a_postSweeps Backward sweeps
+ */
+void Multigrid::setSmoothing(int a_preSweeps, int a_postSweeps) {
+  m_preSweeps = a_preSweeps;
+  m_postSweeps = a_postSweeps;
+}
+
+/**
+ * @brief Refine, build the transfer operators and the Galerkin coarse operators
+ * @param a_coarseMesh Coarsest mesh
+ * @param a_numRefinements Number of refinements
+ * @param a_cMatrix Material matrix
+ * @details Only the finest matrix is assembled from elements. Interior/boundary
+ *          classification of every level comes from a FEGrid of that level, so the
+ *          rows agree with StiffnessAssembler::globalMatrixIndex(). A fine row of an
+ *          old node takes its coarse row with weight 1; a fine row of a midpoint takes
+ *          the rows of its two end nodes with weight 1/2 each, boundary nodes
+ *          (zero Dirichlet values) contributing nothing.
+ */
+void Multigrid::setup(const MeshData& a_coarseMesh, int a_numRefinements, const double a_cMatrix[DIM*DIM]) {
+  int numLevels = a_numRefinements + 1;
+  m_levels.clear();
+  m_levels.resize(numLevels);
+
+  MeshData mesh = a_coarseMesh;
+  std::unique_ptr<FEGrid> grid(new FEGrid(mesh));
+  std::vector<int> coarseRow;
+  {
+    StiffnessAssembler assembler(*grid, a_cMatrix);
+    coarseRow = assembler.globalMatrixIndex();
+    if (numLevels == 1)
+      {
+        assembler.symbolic(m_levels[0].A);
+        assembler.assemble(m_levels[0].A);
+      }
+  }
+
+  for (int l = 1; l < numLevels; l++)
+    {
+      MeshData fine;
+      std::vector<int> ends;
+      refineMesh(mesh, fine, &ends);
+      grid.reset(new FEGrid(fine));
+      StiffnessAssembler assembler(*grid, a_cMatrix);
+      const std::vector<int>& rowNode = assembler.rowNode();
+      int numCoarseNodes = mesh.numNodes();
+      int numCoarseRows = 0;
+      for (int row : coarseRow)
+        numCoarseRows += row >= 0;
+
+      Level& level = m_levels[l];
+      int n = assembler.getNumRows();
+      level.prolongOffsets.assign(n + 1, 0);
+      level.prolongColumns.clear();
+      level.prolongValues.clear();
+      for (int r = 0; r < n; r++)
+        {
+          int node = rowNode[r];
+          if (node < numCoarseNodes)
+            {
+              if (coarseRow[node] >= 0)
+                {
+                  level.prolongColumns.push_back(coarseRow[node]);
+                  level.prolongValues.push_back(1.0);
+                }
+            }
+          else
+            for (int k = 0; k < 2; k++)
+              {
+                int end = ends[2*(node - numCoarseNodes) + k];
+                if (coarseRow[end] >= 0)
+                  {
+                    level.prolongColumns.push_back(coarseRow[end]);
+                    level.prolongValues.push_back(0.5);
+                  }
+              }
+          level.prolongOffsets[r + 1] = level.prolongColumns.size();
+        }
+
+      // restriction = P^T by counting sort on the columns of P
+      level.restrictOffsets.assign(numCoarseRows + 1, 0);
+      for (int c : level.prolongColumns)
+        level.restrictOffsets[c + 1]++;
+      for (int c = 0; c < numCoarseRows; c++)
+        level.restrictOffsets[c + 1] += level.restrictOffsets[c];
+      level.restrictColumns.resize(level.prolongColumns.size());
+      level.restrictValues.resize(level.prolongColumns.size());
+      std::vector<int> fill(level.restrictOffsets.begin(), level.restrictOffsets.end() - 1);
+      for (int r = 0; r < n; r++)
+        for (int k = level.prolongOffsets[r]; k < level.prolongOffsets[r + 1]; k++)
+          {
+            int pos = fill[level.prolongColumns[k]]++;
+            level.restrictColumns[pos] = r;
+            level.restrictValues[pos] = level.prolongValues[k];
+          }
+
+      if (l == numLevels - 1)
+        {
+          assembler.symbolic(level.A);
+          assembler.assemble(level.A);
+        }
+      coarseRow = assembler.globalMatrixIndex();
+      mesh.x.swap(fine.x);
+      mesh.y.swap(fine.y);
+      mesh.boundary.swap(fine.boundary);
+      mesh.vertices.swap(fine.vertices);
+    }
+  m_grid = std::move(grid);
+
+  for (int l = numLevels - 2; l >= 0; l--)
+    galerkin(l);
+  for (Level& level : m_levels)
+    {
+      int n = level.A.getNumRows();
+      level.diag.resize(n);
+      for (int i = 0; i < n; i++)
+        level.diag[i] = level.A.find(i, i);
+      level.x.assign(n, 0.0);
+      level.b.assign(n, 0.0);
+      level.r.assign(n, 0.0);
+    }
+  factorCoarse();
+}
+
+/**
+ * @brief Band Cholesky factor of the level 0 operator in RCM order
+ * @details The given mesh is usually numbered in file order, whose band can span
+ *          the whole matrix; RCM keeps the factor proportional to the rows times
+ *          the mesh width. vcycle() permutes into and out of this order.
+ */
+void Multigrid::factorCoarse() {
+  const CSRMatrix& A = m_levels[0].A;
+  int n = A.getNumRows();
+  m_coarseOrder.buildRCM(A);
+  const std::vector<int>& newToOld = m_coarseOrder.newToOld();
+  const std::vector<int>& oldToNew = m_coarseOrder.oldToNew();
+  const std::vector<int>& aOffsets = A.rowOffsets();
+  const std::vector<int>& aColumns = A.columns();
+  const AlignedVector<double>& aValues = A.values();
+
+  std::vector<int> offsets(n + 1, 0);
+  for (int r = 0; r < n; r++)
+    offsets[r + 1] = offsets[r] + aOffsets[newToOld[r] + 1] - aOffsets[newToOld[r]];
+  std::vector<int> columns(offsets[n]);
+  std::vector<int> source(offsets[n]);
+  std::vector<std::pair<int, int> > row;
+  for (int r = 0; r < n; r++)
+    {
+      int old = newToOld[r];
+      row.clear();
+      for (int k = aOffsets[old]; k < aOffsets[old + 1]; k++)
+        row.push_back(std::make_pair(oldToNew[aColumns[k]], k));
+      std::sort(row.begin(), row.end());
+      for (size_t c = 0; c < row.size(); c++)
+        {
+          columns[offsets[r] + c] = row[c].first;
+          source[offsets[r] + c] = row[c].second;
+        }
+    }
+  CSRMatrix permuted;
+  permuted.setPattern(n, offsets, columns);
+  for (int k = 0; k < offsets[n]; k++)
+    permuted.values()[k] = aValues[source[k]];
+  m_coarseSolver.factor(permuted);
+}
+
+/**
+ * @brief Galerkin product A_c = P^T A_f P
+ * @param a_level Coarse level; level a_level + 1 must hold A and P
+ * @details Row i of A_c sums w1 * a * w2 over the paths i -P^T-> fine row -A-> fine
+ *          column -P-> coarse column. Each thread accumulates its rows in a dense
+ *          array indexed by coarse column, with a marker array to collect the pattern.
+ */
+void Multigrid::galerkin(int a_level) {
+  const Level& fine = m_levels[a_level + 1];
+  int nc = (int)fine.restrictOffsets.size() - 1;
+  const std::vector<int>& aOffsets = fine.A.rowOffsets();
+  const std::vector<int>& aColumns = fine.A.columns();
+  const AlignedVector<double>& aValues = fine.A.values();
+  std::vector<std::vector<int> > rowColumns(nc);
+  std::vector<std::vector<double> > rowValues(nc);
+#pragma omp parallel
+  {
+    std::vector<int> marker(nc, -1);
+    std::vector<double> acc(nc, 0.0);
+#pragma omp for schedule(dynamic, 64)
+    for (int i = 0; i < nc; i++)
+      {
+        std::vector<int>& cols = rowColumns[i];
+        for (int k = fine.restrictOffsets[i]; k < fine.restrictOffsets[i + 1]; k++)
+          {
+            int rf = fine.restrictColumns[k];
+            double w1 = fine.restrictValues[k];
+            for (int a = aOffsets[rf]; a < aOffsets[rf + 1]; a++)
+              {
+                int jf = aColumns[a];
+                double wa = w1 * aValues[a];
+                for (int p = fine.prolongOffsets[jf]; p < fine.prolongOffsets[jf + 1]; p++)
+                  {
+                    int jc = fine.prolongColumns[p];
+                    if (marker[jc] != i)
+                      {
+                        marker[jc] = i;
+                        acc[jc] = 0.0;
+                        cols.push_back(jc);
+                      }
+                    acc[jc] += wa * fine.prolongValues[p];
+                  }
+              }
+          }
+        std::sort(cols.begin(), cols.end());
+        rowValues[i].resize(cols.size());
+        for (size_t c = 0; c < cols.size(); c++)
+          rowValues[i][c] = acc[cols[c]];
+      }
+  }
+
+  std::vector<int> offsets(nc + 1, 0);
+  for (int i = 0; i < nc; i++)
+    offsets[i + 1] = offsets[i] + rowColumns[i].size();
+  std::vector<int> columns(offsets[nc]);
+  for (int i = 0; i < nc; i++)
+    std::copy(rowColumns[i].begin(), rowColumns[i].end(), columns.begin() + offsets[i]);
+  CSRMatrix& A = m_levels[a_level].A;
+  A.setPattern(nc, offsets, columns);
+  for (int i = 0; i < nc; i++)
+    std::copy(rowValues[i].begin(), rowValues[i].end(), A.values().begin() + offsets[i]);
+}
+
+/**
+ * @brief One Gauss-Seidel sweep of level a_level on its x and b
+ * @param a_level Level
+ * @param a_forward Sweep direction
+ */
+void Multigrid::smooth(int a_level, bool a_forward) const {
+  const Level& level = m_levels[a_level];
+  int n = level.A.getNumRows();
+  const int* offsets = level.A.rowOffsets().data();
+  const int* cols = level.A.columns().data();
+  const double* vals = level.A.values().data();
+  const int* diag = level.diag.data();
+  double* x = level.x.data();
+  const double* b = level.b.data();
+  for (int k = 0; k < n; k++)
+    {
+      int i = a_forward ? k : n - 1 - k;
+      double sum = b[i];
+      for (int j = offsets[i]; j < offsets[i + 1]; j++)
+        sum -= vals[j] * x[cols[j]];
+      x[i] += sum / vals[diag[i]];
+    }
+}
+
+/**
+ * @brief V-cycle for A x = b of level a_level, starting from the x stored there
+ * @param a_level Level
+ */
+void Multigrid::vcycle(int a_level) const {
+  const Level& level = m_levels[a_level];
+  int n = level.A.getNumRows();
+  if (a_level == 0)
+    {
+      // r is free on the coarsest level; it holds b and then x in RCM order
+      const std::vector<int>& newToOld = m_coarseOrder.newToOld();
+      for (int i = 0; i < n; i++)
+        level.r[i] = level.b[newToOld[i]];
+      m_coarseSolver.solve(level.r.data());
+      for (int i = 0; i < n; i++)
+        level.x[newToOld[i]] = level.r[i];
+      return;
+    }
+  for (int s = 0; s < m_preSweeps; s++)
+    smooth(a_level, true);
+
+  double* r = level.r.data();
+  const double* b = level.b.data();
+  level.A.multiply(level.x.data(), r);
+#pragma omp parallel for simd schedule(static)
+  for (int i = 0; i < n; i++)
+    r[i] = b[i] - r[i];
+
+  const Level& coarse = m_levels[a_level - 1];
+  int nc = coarse.A.getNumRows();
+  double* bc = coarse.b.data();
+  double* xc = coarse.x.data();
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < nc; i++)
+    {
+      double sum = 0.0;
+      for (int k = level.restrictOffsets[i]; k < level.restrictOffsets[i + 1]; k++)
+        sum += level.restrictValues[k] * r[level.restrictColumns[k]];
+      bc[i] = sum;
+      xc[i] = 0.0;
+    }
+  vcycle(a_level - 1);
+
+  double* x = level.x.data();
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < n; i++)
+    {
+      double sum = 0.0;
+      for (int k = level.prolongOffsets[i]; k < level.prolongOffsets[i + 1]; k++)
+        sum += level.prolongValues[k] * xc[level.prolongColumns[k]];
+      x[i] += sum;
+    }
+  for (int s = 0; s < m_postSweeps; s++)
+    smooth(a_level, false);
+}
+
+/**
+ * @brief One V-cycle from zero
+ * @param a_r Right-hand side on the finest level
+ * @param[out] a_z Result of the cycle
+ */
+void Multigrid::precondition(const double* a_r, double* a_z) const {
+  const Level& top = m_levels.back();
+  int n = top.A.getNumRows();
+  std::copy(a_r, a_r + n, top.b.begin());
+  std::fill(top.x.begin(), top.x.end(), 0.0);
+  vcycle(getNumLevels() - 1);
+  std::copy(top.x.begin(), top.x.end(), a_z);
+}
+
+/**
+ * @brief Stationary V-cycle iteration on the residual equation
+ * @param a_b Right-hand side
+ * @param[in,out] a_x Initial guess, then solution
+ * @param a_tolerance Relative residual tolerance
+ * @param a_maxCycles Cycle limit
+ * @return Cycles done
+ */
+int Multigrid::solve(const double* a_b, double* a_x, double a_tolerance, int a_maxCycles) {
+  const Level& top = m_levels.back();
+  int n = top.A.getNumRows();
+  double* r = top.r.data();
+  double bb = 0.0;
+#pragma omp parallel for simd reduction(+:bb) schedule(static)
+  for (int i = 0; i < n; i++)
+    bb += a_b[i] * a_b[i];
+  double bnorm = std::sqrt(bb);
+  if (bnorm == 0.0)
+    bnorm = 1.0;
+
+  int cycles = 0;
+  while (true)
+    {
+      top.A.multiply(a_x, r);
+      double rr = 0.0;
+#pragma omp parallel for simd reduction(+:rr) schedule(static)
+      for (int i = 0; i < n; i++)
+        {
+          r[i] = a_b[i] - r[i];
+          rr += r[i] * r[i];
+        }
+      m_relativeResidual = std::sqrt(rr) / bnorm;
+      if (m_relativeResidual <= a_tolerance || cycles >= a_maxCycles)
+        break;
+      std::copy(r, r + n, top.b.begin());
+      std::fill(top.x.begin(), top.x.end(), 0.0);
+      vcycle(getNumLevels() - 1);
+#pragma omp parallel for simd schedule(static)
+      for (int i = 0; i < n; i++)
+        a_x[i] += top.x[i];
+      cycles++;
+    }
+  return cycles;
+}
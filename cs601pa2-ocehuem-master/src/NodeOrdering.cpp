@@ -0,0 +1,123 @@
+/**
+ * @file NodeOrdering.cpp
+ * @brief Implementation of reverse Cuthill-McKee row ordering
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include "NodeOrdering.h"
+
+/**
+ * @brief Breadth-first search over the rows reachable from a_root
+ * @param a_root Start row
+ * @param a_offsets Row offsets of the pattern
+ * @param a_columns Column indices of the pattern
+ * @param a_level Level of every row, -1 if not reached; reset to -1 for the
+ *        visited rows before returning
+ * @param[out] a_queue Rows of the component in breadth-first order
+ * @param[out] a_lastLevelStart Index in a_queue of the first row of the last level
+ * @return Number of levels
+ */
+static int breadthFirst(int a_root, const int* a_offsets, const int* a_columns,
+                        std::vector<int>& a_level, std::vector<int>& a_queue,
+                        int& a_lastLevelStart) {
+  a_queue.clear();
+  a_queue.push_back(a_root);
+  a_level[a_root] = 0;
+  a_lastLevelStart = 0;
+  for (size_t head = 0; head < a_queue.size(); head++)
+    {
+      int row = a_queue[head];
+      if (a_level[row] != a_level[a_queue[a_lastLevelStart]])
+        a_lastLevelStart = head;
+      for (int k = a_offsets[row]; k < a_offsets[row + 1]; k++)
+        if (a_level[a_columns[k]] < 0)
+          {
+            a_level[a_columns[k]] = a_level[row] + 1;
+            a_queue.push_back(a_columns[k]);
+          }
+    }
+  int numLevels = a_level[a_queue.back()] + 1;
+  for (int row : a_queue)
+    a_level[row] = -1;
+  return numLevels;
+}
+
+/**
+ * @brief Reverse Cuthill-McKee over all connected components
+ * @param a_pattern Structurally symmetric matrix
+ * @details The start row of a component is found by the usual pseudo-peripheral
+ *          search: restart from a minimum-degree row of the last level as long as
+ *          the number of levels grows.
+ */
+void NodeOrdering::buildRCM(const CSRMatrix& a_pattern) {
+  int n = a_pattern.getNumRows();
+  const int* offsets = a_pattern.rowOffsets().data();
+  const int* columns = a_pattern.columns().data();
+  std::vector<int> degree(n);
+  for (int row = 0; row < n; row++)
+    degree[row] = offsets[row + 1] - offsets[row];
+
+  std::vector<int> level(n, -1);
+  std::vector<char> numbered(n, 0);
+  std::vector<int> queue, candidateQueue, neighbours;
+  auto byDegree = [&](int a, int b) { return degree[a] < degree[b]; };
+  m_newToOld.clear();
+  m_newToOld.reserve(n);
+  for (int seed = 0; seed < n; seed++)
+    {
+      if (numbered[seed])
+        continue;
+      // minimum-degree row of the component, then pseudo-peripheral search
+      int last;
+      breadthFirst(seed, offsets, columns, level, queue, last);
+      int root = *std::min_element(queue.begin(), queue.end(), byDegree);
+      int numLevels = breadthFirst(root, offsets, columns, level, queue, last);
+      while (true)
+        {
+          int candidate = *std::min_element(queue.begin() + last, queue.end(), byDegree);
+          int candidateLast;
+          int candidateLevels = breadthFirst(candidate, offsets, columns, level, candidateQueue, candidateLast);
+          if (candidateLevels <= numLevels)
+            break;
+          root = candidate;
+          numLevels = candidateLevels;
+          queue.swap(candidateQueue);
+          last = candidateLast;
+        }
+
+      // Cuthill-McKee: breadth first from root, neighbours by increasing degree
+      size_t head = m_newToOld.size();
+      m_newToOld.push_back(root);
+      numbered[root] = 1;
+      for (; head < m_newToOld.size(); head++)
+        {
+          int row = m_newToOld[head];
+          neighbours.clear();
+          for (int k = offsets[row]; k < offsets[row + 1]; k++)
+            if (!numbered[columns[k]])
+              {
+                numbered[columns[k]] = 1;
+                neighbours.push_back(columns[k]);
+              }
+          std::stable_sort(neighbours.begin(), neighbours.end(), byDegree);
+          m_newToOld.insert(m_newToOld.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+  assert((int)m_newToOld.size() == n);
+  std::reverse(m_newToOld.begin(), m_newToOld.end());
+  set(m_newToOld);
+}
+
+/**
+ * @brief Use a given permutation
+ * @param a_newToOld Old row of every new row
+ */
+void NodeOrdering::set(const std::vector<int>& a_newToOld) {
+  if (&a_newToOld != &m_newToOld)
+    m_newToOld = a_newToOld;
+  m_oldToNew.assign(m_newToOld.size(), -1);
+  for (int r = 0; r < (int)m_newToOld.size(); r++)
+    m_oldToNew[m_newToOld[r]] = r;
+}
@@ -7,6 +7,7 @@
  */
 
 #include "../inc/RDomain.h"
+#include "../inc/DumpWriter.h"
 #include <cstdio>
 #include <cassert>
 
@@ -52,7 +53,7 @@ void RDomain::GenerateGrid() {
 /**
  * @brief Writes the grid coordinates to a binary file
  * @param outputFileName Name of the file to write the grid data
- * @throws assertion error if file cannot be opened
+ * @throws std::runtime_error if the file cannot be created or written
  * @details Writes the grid coordinates to a binary file in the following format:
  *          - First writes all x-coordinates (sizeof(double) * nx bytes)
  *          - Then writes all y-coordinates (sizeof(double) * ny bytes)
@@ -62,11 +63,20 @@ void RDomain::GenerateGrid() {
  * floating-point values.
  */
 void RDomain::PrintGrid(const std::string &outputFileName) const {
-    FILE *fp = fopen(outputFileName.c_str(), "wb");
-    assert(fp && "Failed to open file.");
-    fwrite(gridX.data(), sizeof(double), gridX.size(), fp);
-    fwrite(gridY.data(), sizeof(double), gridY.size(), fp);
-    fclose(fp);
+    DumpWriter writer(outputFileName);
+    PrintGrid(writer);
+    writer.close();
+}
+
+/**
+ * @brief Appends the grid coordinates to a dump file
+ * @param writer Open dump writer
+ * @details Same layout as PrintGrid(outputFileName). The data is copied into
+ *          the writer's buffer; the disk write happens on its background thread.
+ */
+void RDomain::PrintGrid(DumpWriter &writer) const {
+    writer.write(gridX.data(), sizeof(double) * gridX.size());
+    writer.write(gridY.data(), sizeof(double) * gridY.size());
 }
 
 /**
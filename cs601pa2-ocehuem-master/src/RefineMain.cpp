@@ -0,0 +1,97 @@
+/**
+ * @file RefineMain.cpp
+ * @brief Command line tool producing large benchmark meshes by uniform refinement
+ *
+ * Usage: ./refine <input prefix> <output prefix> [levels] [morton|hilbert]
+ * Reads <input prefix>.node/.elem, splits every triangle into four [levels]
+ * times (default 1) and writes <output prefix>.node/.elem together with the
+ * binary <output prefix>.femesh, which carries the boundary flags and which
+ * FEGrid loads instead of the text files. With a curve name, elements are
+ * finally sorted along that space-filling curve and nodes renumbered by first
+ * touch (reorderMesh); levels may be 0 to only reorder.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "MeshIO.h"
+#include "MeshRefinement.h"
+#include "MeshReordering.h"
+
+using namespace std;
+
+/**
+ * @brief Seconds elapsed since a_start
+ */
+static double secondsSince(const std::chrono::steady_clock::time_point& a_start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - a_start).count();
+}
+
+int main(int argc, char** argv) {
+  if(argc < 3)
+    {
+      cout << "usage: " << argv[0] << " <input prefix> <output prefix> [levels] [morton|hilbert]" << endl;
+      return 1;
+    }
+  string in(argv[1]), out(argv[2]);
+  int levels = (argc > 3) ? atoi(argv[3]) : 1;
+  if(levels < 0)
+    {
+      cout << "levels must be non-negative" << endl;
+      return 1;
+    }
+  string curve = (argc > 4) ? argv[4] : "";
+  if(!curve.empty() && curve != "morton" && curve != "hilbert")
+    {
+      cout << "unknown curve " << curve << ", use morton or hilbert" << endl;
+      return 1;
+    }
+
+  MeshData mesh, refined;
+  auto start = std::chrono::steady_clock::now();
+  readTextMesh(in+".node", in+".elem", mesh);
+  cout<<"read "<<mesh.numNodes()<<" nodes, "<<mesh.numElts()<<" elements in "<<secondsSince(start)<<" s"<<endl;
+
+  for(int level=1; level<=levels; level++) {
+    start = std::chrono::steady_clock::now();
+    refineMesh(mesh, refined);
+    double t = secondsSince(start);
+    mesh.x.swap(refined.x);
+    mesh.y.swap(refined.y);
+    mesh.boundary.swap(refined.boundary);
+    mesh.vertices.swap(refined.vertices);
+    int numBoundary = 0;
+    for(unsigned char b : mesh.boundary)
+      numBoundary += b;
+    cout<<"level "<<level<<": "<<mesh.numNodes()<<" nodes ("<<numBoundary<<" on the boundary), "
+        <<mesh.numElts()<<" elements in "<<t<<" s ("<<mesh.numElts()/t<<" elements/s)"<<endl;
+  }
+
+  if(!curve.empty()) {
+    start = std::chrono::steady_clock::now();
+    reorderMesh(mesh, refined, curve == "hilbert" ? HILBERT : MORTON);
+    mesh.x.swap(refined.x);
+    mesh.y.swap(refined.y);
+    mesh.boundary.swap(refined.boundary);
+    mesh.vertices.swap(refined.vertices);
+    cout<<"reordered along the "<<curve<<" curve in "<<secondsSince(start)<<" s"<<endl;
+  }
+
+  start = std::chrono::steady_clock::now();
+  if(!writeTextMesh(out+".node", out+".elem", mesh))
+    {
+      cout << "cannot write " << out << ".node/.elem" << endl;
+      return 1;
+    }
+  double tText = secondsSince(start);
+  // written last so it is newer than the text files and FEGrid picks it up
+  start = std::chrono::steady_clock::now();
+  if(!writeMeshCache(out+".femesh", mesh))
+    {
+      cout << "cannot write " << out << ".femesh" << endl;
+      return 1;
+    }
+  cout<<"wrote "<<out<<".node/.elem in "<<tText<<" s and "<<out<<".femesh in "<<secondsSince(start)<<" s"<<endl;
+  return 0;
+}
@@ -8,7 +8,13 @@
  */
 
 #include "../inc/Solution.h"
+#include "../inc/DumpWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 #include <cmath>
 #include <limits>
@@ -35,7 +41,105 @@ Solution::Solution(double len, double dx, double dt, double thermalDiff, int ste
       gridFunction(len, dx),   // Initialize the grid function
       alpha(thermalDiff),      // Set thermal diffusivity
       deltaT(dt),              // Set time step
-      maxSteps(steps) {}       // Set maximum simulation steps
+      maxSteps(steps),         // Set maximum simulation steps
+      outputMode(PRINT_STEPS),  // Print every step, as before
+      printEvery(1),
+      snapshotEvery(0),        // No snapshot file
+      checkEvery(1) {}         // Check convergence every step
+
+/**
+ * @brief Largest time step known to be stable for the current grid and diffusivity
+ * @return The smaller of the Lanczos estimate and dx^2 / (2 alpha)
+ */
+double Solution::StableTimeStep() const {
+    double dx = domain.GetDelta();
+    return std::min(EstimatedStepLimit(), dx * dx / (2 * alpha));
+}
+
+/**
+ * @brief Lanczos estimate of the stability limit
+ * @return 2 / (upper estimate of lambda_max) of the spatial operator
+ */
+double Solution::EstimatedStepLimit() const {
+    return gridFunction.StableTimeStep(alpha);
+}
+
+/**
+ * @brief Sets the time step and the number of steps
+ * @param dt Time step size
+ * @param steps Maximum number of time steps
+ */
+void Solution::SetTimeStep(double dt, int steps) {
+    deltaT = dt;
+    maxSteps = steps;
+}
+
+/**
+ * @brief Chooses the fewest equal stable steps reaching endTime
+ * @param endTime Time to reach
+ * @return Number of steps
+ */
+int Solution::FitTimeStep(double endTime) {
+    if (!(endTime > 0))
+        throw std::invalid_argument("End time must be positive");
+    double ratio = std::ceil(endTime / StableTimeStep());
+    if (!(ratio <= std::numeric_limits<int>::max()))
+        throw std::invalid_argument("End time needs more than INT_MAX stable steps");
+    int steps = std::max(1, static_cast<int>(ratio));
+    SetTimeStep(endTime / steps, steps);
+    return steps;
+}
+
+/**
+ * @brief Sets what Simulate() prints
+ * @param mode Output mode
+ * @param every Step cadence of PRINT_STEPS
+ */
+void Solution::SetOutput(OutputMode mode, int every) {
+    if (every <= 0)
+        throw std::invalid_argument("Output cadence must be positive");
+    outputMode = mode;
+    printEvery = every;
+}
+
+/**
+ * @brief Sets the step cadence of the convergence check
+ * @param every Step cadence
+ */
+void Solution::SetConvergenceCheck(int every) {
+    if (every <= 0)
+        throw std::invalid_argument("Convergence check cadence must be positive");
+    checkEvery = every;
+}
+
+/**
+ * @brief Sets the binary snapshot file and cadence
+ * @param fileName Output file
+ * @param every Step cadence, 0 for none
+ */
+void Solution::SetSnapshots(const std::string &fileName, int every) {
+    if (every < 0)
+        throw std::invalid_argument("Snapshot cadence must not be negative");
+    snapshotFile = fileName;
+    snapshotEvery = every;
+}
+
+/**
+ * @brief Appends one snapshot record
+ * @param writer Open dump writer
+ * @param step Steps taken so far
+ * @details Header (int32 step, int32 nx, double dx, double dt) and values are
+ *          copied into the writer's buffer; the disk write happens on its
+ *          background thread.
+ */
+void Solution::WriteSnapshot(DumpWriter &writer, int step) const {
+    const auto& values = gridFunction.GetValues();
+    int32_t counts[2] = {step, static_cast<int32_t>(values.size())};
+    double spacing[2] = {domain.GetDelta(), deltaT};
+    writer.write(counts, sizeof(counts));
+    writer.write(spacing, sizeof(spacing));
+    writer.write(values.data(), sizeof(double) * values.size());
+}
 
 /**
  * @brief Executes the heat equation simulation
@@ -45,6 +149,9 @@ Solution::Solution(double len, double dx, double dt, double thermalDiff, int ste
  * 2. Updates the grid function at each time step using the explicit scheme
  * 3. Prints the final temperature values at each spatial point
  * 
+ * What is printed, and how often, is set by SetOutput(); snapshots set by
+ * SetSnapshots() are streamed to a binary file by a background thread.
+ * 
  * The simulation uses an explicit finite difference scheme:
  * u(x,t+dt) = u(x,t) + alpha * dt/dx^2 * [u(x+dx,t) - 2u(x,t) + u(x-dx,t)]
  * 
@@ -56,41 +163,56 @@ Solution::Solution(double len, double dx, double dt, double thermalDiff, int ste
 
 void Solution::Simulate() {
     double maxError = std::numeric_limits<double>::max(); // Initial max error
-    std::vector<double> previousValues;
+    int stepsTaken = 0;
+    bool converged = false;
+    auto start = std::chrono::steady_clock::now();
 
 const auto& currentValues = gridFunction.GetValues();
 
+    // Snapshots go through the background writer; the loop only copies into its buffer
+    std::unique_ptr<DumpWriter> snapshots;
+    if (snapshotEvery > 0) {
+        snapshots.reset(new DumpWriter(snapshotFile));
+        WriteSnapshot(*snapshots, 0);
+    }
+
     // Print the grid size
-    std::cout << "Number of grid points: " << currentValues.size() << std::endl;
+    if (outputMode != PRINT_SUMMARY)
+        std::cout << "Number of grid points: " << currentValues.size() << std::endl;
     // Perform time-stepping for the simulation
     for (int step = 0; step < maxSteps; ++step) {
-        // Store the previous values to compute the error
-        previousValues = gridFunction.GetValues();
-        
-        // Update the grid function (compute the next time step)
-        gridFunction.Update(alpha, deltaT);
+        // Update the grid function (compute the next time step), measuring
+        // the maximum error (difference between previous and current) in the
+        // same sweep on the steps that check or print it. The last step is
+        // always checked, so the final error is a measured one
+        stepsTaken = step + 1;
+        bool check = stepsTaken % checkEvery == 0 || stepsTaken == maxSteps;
+        bool print = outputMode == PRINT_STEPS && step % printEvery == 0;
+        if (check || print)
+            maxError = gridFunction.UpdateWithChange(alpha, deltaT);
+        else
+            gridFunction.Update(alpha, deltaT);
         
         // Get the current temperature values
         const auto& currentValues = gridFunction.GetValues();
 
-        // Compute the maximum error (difference between previous and current)
-        maxError = 0.0;
-        for (size_t i = 0; i < currentValues.size(); ++i) {
-            double error = std::abs(currentValues[i] - previousValues[i]);
-            if (error > maxError) {
-                maxError = error;
+        // Output the current step's information
+        if (print) {
+            std::cout << "step " << step << " max error= " << maxError;
+            for (size_t i = 0; i < currentValues.size(); ++i) {
+                std::cout << ", Grid[" << i << "]=" << currentValues[i];
             }
+            std::cout << std::endl;
         }
 
-        // Output the current step's information
-        std::cout << "step " << step << " max error= " << maxError;
-        for (size_t i = 0; i < currentValues.size(); ++i) {
-            std::cout << ", Grid[" << i << "]=" << currentValues[i];
-        }
-        std::cout << std::endl;
+        if (snapshots && stepsTaken % snapshotEvery == 0)
+            WriteSnapshot(*snapshots, stepsTaken);
 
         // Check for convergence (if max error is below a certain threshold)
-        if (maxError < 1e-6) {
+        if (check && maxError < 1e-6) {
+            converged = true;
+            if (outputMode == PRINT_SUMMARY)
+                break;
             std::cout << "Solution converged XCoordinates= ";
             for (size_t i = 0; i < currentValues.size(); ++i) {
                 // Manually compute the X-coordinate using delta
@@ -105,4 +227,22 @@ const auto& currentValues = gridFunction.GetValues();
             break; // Exit the loop if the solution has converged
         }
     }
+
+    // The last state is always in the file
+    if (snapshots) {
+        if (stepsTaken % snapshotEvery != 0)
+            WriteSnapshot(*snapshots, stepsTaken);
+        snapshots->close();
+    }
+
+    if (outputMode == PRINT_SUMMARY) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << currentValues.size() << " grid points, " << stepsTaken << " steps"
+                  << (converged ? " (converged)" : "") << ", max error= ";
+        if (stepsTaken > 0)
+            std::cout << maxError;
+        else
+            std::cout << "not measured";
+        std::cout << ", " << seconds << " s, " << stepsTaken / seconds << " steps/s" << std::endl;
+    }
 }
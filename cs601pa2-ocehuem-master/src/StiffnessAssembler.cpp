@@ -0,0 +1,281 @@
+/**
+ * @file StiffnessAssembler.cpp
+ * @brief Implementation of symbolic and numeric sparse stiffness assembly
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#ifdef CBLAS_DGEMM
+#include <cblas.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "StiffnessAssembler.h"
+#include "DumpWriter.h"
+
+/**
+ * @brief Set up an assembler
+ * @param a_grid Grid to assemble over
+ * @param a_cMatrix Material matrix C
+ * @details Interior nodes get consecutive rows in node order.
+ */
+StiffnessAssembler::StiffnessAssembler(const FEGrid& a_grid, const double a_cMatrix[DIM*DIM])
+  : m_grid(a_grid), m_numRows(0), m_areaWeighted(false) {
+  for (int k = 0; k < DIM*DIM; k++)
+    m_cMatrix[k] = a_cMatrix[k];
+  int numNodes = m_grid.getNumNodes();
+  m_globalMatrixIndex.resize(numNodes);
+  for (int i = 0; i < numNodes; i++)
+    if (m_grid.node(i).isInterior())
+      {
+        m_globalMatrixIndex[i] = m_numRows++;
+        m_rowNode.push_back(i);
+      }
+    else
+      m_globalMatrixIndex[i] = -1;
+}
+
+/**
+ * @brief Permute the rows
+ * @param a_ordering Permutation of the current rows
+ * @details The slot table refers to the old numbering and is dropped.
+ */
+void StiffnessAssembler::renumber(const NodeOrdering& a_ordering) {
+  assert(a_ordering.getNumRows() == m_numRows);
+  const std::vector<int>& oldToNew = a_ordering.oldToNew();
+  std::vector<int> rowNode(m_numRows);
+  for (int row = 0; row < m_numRows; row++)
+    rowNode[oldToNew[row]] = m_rowNode[row];
+  m_rowNode.swap(rowNode);
+  for (int row = 0; row < m_numRows; row++)
+    m_globalMatrixIndex[m_rowNode[row]] = row;
+  m_slots.clear();
+}
+
+/**
+ * @brief Build the CSR pattern and the element slot table
+ * @param[out] a_K Matrix receiving the pattern
+ * @details For each row, the columns are the interior nodes of all elements
+ *          around it (node-to-element lists of the grid topology), sorted and deduplicated.
+ *          Then every interior/interior pair of every element is located in its row.
+ */
+void StiffnessAssembler::symbolic(CSRMatrix& a_K) {
+  const MeshTopology& topo = m_grid.topology();
+  const std::vector<int>& nodeEltOffsets = topo.nodeEltOffsets();
+  const std::vector<int>& nodeElts = topo.nodeElts();
+
+  std::vector<int> rowOffsets(m_numRows + 1, 0);
+  std::vector<int> columns;
+  std::vector<int> rowColumns;
+  for (int row = 0; row < m_numRows; row++)
+    {
+      int node = m_rowNode[row];
+      rowColumns.clear();
+      for (int k = nodeEltOffsets[node]; k < nodeEltOffsets[node + 1]; k++)
+        {
+          const Element& e = m_grid.element(nodeElts[k]);
+          for (int ivert = 0; ivert < VERTICES; ivert++)
+            {
+              int col = m_globalMatrixIndex[e[ivert]];
+              if (col >= 0)
+                rowColumns.push_back(col);
+            }
+        }
+      std::sort(rowColumns.begin(), rowColumns.end());
+      rowColumns.erase(std::unique(rowColumns.begin(), rowColumns.end()), rowColumns.end());
+      columns.insert(columns.end(), rowColumns.begin(), rowColumns.end());
+      rowOffsets[row + 1] = rowColumns.size();
+    }
+  for (int row = 0; row < m_numRows; row++)
+    rowOffsets[row + 1] += rowOffsets[row];
+  a_K.setPattern(m_numRows, rowOffsets, columns);
+
+  int ncell = m_grid.getNumElts();
+  m_slots.assign(ncell * VERTICES * VERTICES, -1);
+  for (int i = 0; i < ncell; i++)
+    {
+      const Element& e = m_grid.element(i);
+      for (int m = 0; m < VERTICES; m++)
+        {
+          int row = m_globalMatrixIndex[e[m]];
+          if (row < 0)
+            continue;
+          for (int n = 0; n < VERTICES; n++)
+            {
+              int col = m_globalMatrixIndex[e[n]];
+              if (col >= 0)
+                m_slots[(i * VERTICES + m) * VERTICES + n] = a_K.find(row, col);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fixed-size element stiffness kernel
+ * @param a_eltNumber Element number
+ * @param[out] a_kij B^T C B (VERTICES x VERTICES, row-major), times the area if area weighted
+ * @param[out] a_kijpartial B^T C (VERTICES x DIM, row-major)
+ * @details Everything lives on the stack with sizes fixed by VERTICES and DIM.
+ *          Rows of B^T (shape function gradients) belonging to boundary nodes are
+ *          multiplied by a zero mask instead of being compacted away, so the loops
+ *          have constant trip counts. kij is formed from B^T C and the rows of B^T
+ *          directly; no transposed copy of B is built.
+ */
+void StiffnessAssembler::elementMatrix(int a_eltNumber, double a_kij[VERTICES*VERTICES],
+                                       double a_kijpartial[VERTICES*DIM]) const {
+  static_assert(VERTICES == 3 && DIM == 2, "element kernel is written for linear triangles");
+  const Element& e = m_grid.element(a_eltNumber);
+
+  //B^T: gradient of the shape function of every vertex, masked for boundary nodes
+  double bMatrixTrans[VERTICES*DIM];
+  for(int m=0;m<VERTICES;m++) {
+    m_grid.gradient(bMatrixTrans+m*DIM, a_eltNumber, m);
+    double mask = m_globalMatrixIndex[e[m]] >= 0 ? 1.0 : 0.0;
+    for(int r=0;r<DIM;r++)
+      bMatrixTrans[m*DIM+r] *= mask;
+  }
+#ifndef CBLAS_DGEMM
+  //compute B^T * C (3x2 * 2x2)
+  for(int m=0;m<VERTICES;m++)
+    for(int n=0;n<DIM;n++) {
+      double sum = 0.;
+      for(int r=0;r<DIM;r++)
+        sum += bMatrixTrans[m*DIM+r] * m_cMatrix[r*DIM+n];
+      a_kijpartial[m*DIM+n] = sum;
+    }
+#else
+  //https://www.intel.com/content/www/us/en/develop/documentation/mkl-tutorial-c/top/multiplying-matrices-using-dgemm.html
+  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, VERTICES, DIM, DIM, 1.0, bMatrixTrans, DIM, m_cMatrix, DIM, 0.0, a_kijpartial, DIM);
+#endif
+  //(B^T * C) * B, reading B^T row-wise in place of B's columns
+  double scale = m_areaWeighted ? m_grid.elementArea(a_eltNumber) : 1.0;
+  for(int m=0;m<VERTICES;m++)
+    for(int n=0;n<VERTICES;n++) {
+      double sum = 0.;
+      for(int r=0;r<DIM;r++)
+        sum += a_kijpartial[m*DIM+r] * bMatrixTrans[n*DIM+r];
+      a_kij[m*VERTICES+n] = scale * sum;
+    }
+}
+
+/**
+ * @brief Add an element matrix into the global matrix
+ * @param a_K Global matrix
+ * @param a_eltNumber Element number
+ * @param a_kij Masked VERTICES x VERTICES element matrix
+ * @details No searching: every entry goes to the slot precomputed by symbolic();
+ *          entries involving boundary nodes have no slot and are skipped.
+ */
+void StiffnessAssembler::scatter(CSRMatrix& a_K, int a_eltNumber, const double a_kij[VERTICES*VERTICES]) const {
+  double* values = a_K.values().data();
+  const int* slots = &m_slots[a_eltNumber * VERTICES * VERTICES];
+  for(int k=0;k<VERTICES*VERTICES;k++)
+    if(slots[k] >= 0)
+      values[slots[k]] += a_kij[k];
+}
+
+/**
+ * @brief Numeric phase over all elements
+ * @param a_K Global matrix set up by symbolic()
+ * @param a_dump Optional dump of the element B^T C blocks
+ */
+void StiffnessAssembler::assemble(CSRMatrix& a_K, DumpWriter* a_dump) const {
+  a_K.zero();
+  double kij[VERTICES*VERTICES];
+  double kijpartial[VERTICES*DIM];
+  for (int i = 0; i < m_grid.getNumElts(); i++)
+    {
+      elementMatrix(i, kij, kijpartial);
+      scatter(a_K, i, kij);
+      if (a_dump)
+        a_dump->writeBlock(i, kijpartial, VERTICES*DIM);
+    }
+}
+
+/**
+ * @brief Parallel numeric phase, one color at a time
+ * @param a_K Global matrix set up by symbolic()
+ * @param a_coloring Element coloring of the same grid
+ * @param a_dump Optional dump of the element B^T C blocks
+ * @details The dump writer takes one caller at a time; appends are cheap memory
+ *          copies, the disk writes happen on the writer's own thread.
+ */
+void StiffnessAssembler::assembleColored(CSRMatrix& a_K, const ElementColoring& a_coloring,
+                                         DumpWriter* a_dump) const {
+  a_K.zero();
+  const std::vector<int>& colorOffsets = a_coloring.colorOffsets();
+  const int* elts = a_coloring.elts().data();
+#pragma omp parallel
+  {
+    double kij[VERTICES*VERTICES];
+    double kijpartial[VERTICES*DIM];
+    for (int c = 0; c < a_coloring.getNumColors(); c++)
+      {
+        // implicit barrier at the end of each color
+#pragma omp for schedule(static)
+        for (int k = colorOffsets[c]; k < colorOffsets[c + 1]; k++)
+          {
+            int i = elts[k];
+            elementMatrix(i, kij, kijpartial);
+            scatter(a_K, i, kij);
+            if (a_dump)
+              {
+#pragma omp critical(StiffnessAssemblerDump)
+                a_dump->writeBlock(i, kijpartial, VERTICES*DIM);
+              }
+          }
+      }
+  }
+}
+
+/**
+ * @brief Parallel numeric phase with per-thread value buffers
+ * @param a_K Global matrix set up by symbolic()
+ */
+void StiffnessAssembler::assembleThreadBuffers(CSRMatrix& a_K) const {
+  int nnz = a_K.getNumNonzeros();
+  int nthreads = 1;
+#ifdef _OPENMP
+  nthreads = omp_get_max_threads();
+#endif
+  std::vector<double> buffers((size_t)nthreads * nnz, 0.0);
+  double* values = a_K.values().data();
+#pragma omp parallel
+  {
+    int tid = 0;
+#ifdef _OPENMP
+    tid = omp_get_thread_num();
+#endif
+    double* mine = &buffers[(size_t)tid * nnz];
+    double kij[VERTICES*VERTICES];
+    double kijpartial[VERTICES*DIM];
+#pragma omp for schedule(static)
+    for (int i = 0; i < m_grid.getNumElts(); i++)
+      {
+        elementMatrix(i, kij, kijpartial);
+        const int* slots = &m_slots[i * VERTICES * VERTICES];
+        for (int k = 0; k < VERTICES*VERTICES; k++)
+          if (slots[k] >= 0)
+            mine[slots[k]] += kij[k];
+      }
+    // reduction: every thread sums a contiguous range of entries over all buffers
+#pragma omp for schedule(static)
+    for (int k = 0; k < nnz; k++)
+      {
+        double sum = 0.0;
+        for (int t = 0; t < nthreads; t++)
+          sum += buffers[(size_t)t * nnz + k];
+        values[k] = sum;
+      }
+  }
+}
+
+/**
+ * @brief Memory held by the assembler itself
+ * @return Bytes of globalMatrixIndex(), rowNode() and the element slot table
+ */
+size_t StiffnessAssembler::memoryBytes() const {
+  return (m_globalMatrixIndex.size() + m_rowNode.size() + m_slots.size()) * sizeof(int);
+}
@@ -9,27 +9,48 @@
  */
 
 #include "../inc/Solution.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
 
 /**
  * @brief Main entry point for the heat equation simulation program
  *
- * @param argc Number of command line arguments (expected: 4)
+ * @param argc Number of command line arguments (4 or 5, plus options)
  * @param argv Array of command line arguments:
  *             argv[0]: Program name
  *             argv[1]: Length of the domain
- *             argv[2]: Time step size (deltaT)
+ *             argv[2]: Time step size (deltaT), or "auto" for the largest stable one
  *             argv[3]: Space step size (deltaX)
+ *             argv[4]: Optional end time; the step count is then chosen to reach it
+ *             Options, after the numbers:
+ *             --every K: print the step line every K steps instead of every step
+ *             --converged: print only the converged solution
+ *             --summary: print one summary line (steps, error, timing) at the end
+ *             --check K: check for convergence only every K steps
+ *             --snapshots FILE K: stream the values every K steps to the binary
+ *             file FILE (see Solution::SetSnapshots() for the record layout)
  * 
  * @return int Returns 0 on successful execution, 1 if invalid arguments provided
+ *             (including deltaT <= 0, endTime <= 0, or more than INT_MAX steps)
  * 
  * @details This program simulates heat diffusion in a 1D domain using the following parameters:
  *          - length: The total length of the domain
  *          - deltaT: Time step size for the simulation
  *          - deltaX: Space discretization step size
  *          - alpha: Thermal diffusivity (set to 1.0)
- *          - maxSteps: Maximum number of simulation steps (set to 100)
+ *          - maxSteps: Maximum number of simulation steps (100 without an end time)
+ * 
+ * The stable time step limit is estimated with a few Lanczos iterations on the
+ * spatial operator. With "auto" the simulation uses that limit; with an end
+ * time it takes the fewest equal stable steps ending exactly there (deltaT then
+ * only caps the step). The step used is capped by the Gershgorin step
+ * dx^2/(2 alpha), since the Lanczos estimate alone is not guaranteed. A given
+ * deltaT above the Lanczos estimate draws a warning, since the run would blow up.
  * 
  * The program checks for correct number of command line arguments and initializes
  * the Solution class with the provided parameters. It then runs the simulation
@@ -38,23 +59,95 @@
  * Example usage:
  * @code
  *     ./simulation 1.2 0.1 0.4
+ *     ./simulation 1.2 auto 0.01 0.5
+ *     ./simulation 1.0 auto 0.001 0.1 --summary --snapshots heat.snap 1000
  * @endcode
  */
 int main(int argc, char** argv) {
+    // Split positional arguments from options
+    std::vector<std::string> args;
+    Solution::OutputMode outputMode = Solution::PRINT_STEPS;
+    int printEvery = 1;
+    std::string snapshotFile;
+    int snapshotEvery = 0;
+    int checkEvery = 1;
+    bool badOption = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--every" && i + 1 < argc) {
+            printEvery = atoi(argv[++i]);
+            badOption = badOption || printEvery <= 0;
+        } else if (arg == "--converged") {
+            outputMode = Solution::PRINT_CONVERGED;
+        } else if (arg == "--summary") {
+            outputMode = Solution::PRINT_SUMMARY;
+        } else if (arg == "--check" && i + 1 < argc) {
+            checkEvery = atoi(argv[++i]);
+            badOption = badOption || checkEvery <= 0;
+        } else if (arg == "--snapshots" && i + 2 < argc) {
+            snapshotFile = argv[++i];
+            snapshotEvery = atoi(argv[++i]);
+            badOption = badOption || snapshotEvery <= 0;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            badOption = true;
+        } else {
+            args.push_back(arg);
+        }
+    }
+
     // Check if correct number of command line arguments are provided
-    if (argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " <length> <deltaT> <deltaX>" << std::endl;
+    if ((args.size() != 3 && args.size() != 4) || badOption) {
+        std::cerr << "Usage: " << argv[0] << " <length> <deltaT|auto> <deltaX> [endTime]"
+                  << " [--every K | --converged | --summary] [--check K] [--snapshots FILE K]" << std::endl;
         return 1;
     }
 
     // Convert command line arguments to appropriate data types
-    double length = atof(argv[1]);   // Domain length
-    double deltaT = atof(argv[2]);   // Time step size
-    double deltaX = atof(argv[3]);   // Space step size
+    double length = atof(args[0].c_str());   // Domain length
+    bool autoStep = args[1] == "auto";
+    double deltaT = autoStep ? 0.0 : atof(args[1].c_str());   // Time step size
+    double deltaX = atof(args[2].c_str());   // Space step size
+    double endTime = args.size() == 4 ? atof(args[3].c_str()) : 0.0;
+    if (!autoStep && !(deltaT > 0)) {
+        std::cerr << "deltaT must be positive or \"auto\"" << std::endl;
+        return 1;
+    }
+    if (args.size() == 4 && !(endTime > 0)) {
+        std::cerr << "endTime must be positive" << std::endl;
+        return 1;
+    }
 
     // Initialize the solver with simulation parameters
     // Using alpha = 1.0 (thermal diffusivity) and maxSteps = 100
     Solution solver(length, deltaX, deltaT, 1.0, 100);
+    solver.SetOutput(outputMode, printEvery);
+    solver.SetConvergenceCheck(checkEvery);
+    if (snapshotEvery > 0)
+        solver.SetSnapshots(snapshotFile, snapshotEvery);
+
+    // Pick or check the time step against the estimated stability limit
+    double stableT = solver.StableTimeStep();
+    if (args.size() == 4) {
+        double stepCount = std::ceil(endTime / (autoStep ? stableT : std::min(deltaT, stableT)));
+        if (!(stepCount <= std::numeric_limits<int>::max())) {
+            std::cerr << "reaching t = " << endTime << " needs more than "
+                      << std::numeric_limits<int>::max() << " steps" << std::endl;
+            return 1;
+        }
+        int steps = solver.FitTimeStep(endTime);
+        if (!autoStep && deltaT < endTime / steps) {
+            steps = static_cast<int>(std::ceil(endTime / deltaT));
+            solver.SetTimeStep(endTime / steps, steps);
+        }
+        std::cout << "Stable deltaT limit " << stableT << ", " << steps << " steps of "
+                  << endTime / steps << " to reach t = " << endTime << std::endl;
+    } else if (autoStep) {
+        solver.SetTimeStep(stableT, 100);
+        std::cout << "Stable deltaT limit " << stableT << ", using it" << std::endl;
+    } else if (deltaT > solver.EstimatedStepLimit()) {
+        std::cerr << "warning: deltaT " << deltaT << " exceeds the estimated stable limit "
+                  << solver.EstimatedStepLimit() << "; the solution will grow without bound" << std::endl;
+    }
 
     // Run the simulation
     solver.Simulate();